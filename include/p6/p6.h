@@ -4,9 +4,12 @@
 #include "../../src/Canvas.h"
 #include "../../src/Color.h"
 #include "../../src/Context.h"
+#include "../../src/DrawList.h"
 #include "../../src/Image.h"
 #include "../../src/NamedColor.h"
+#include "../../src/Path.h"
 #include "../../src/Shader.h"
+#include "../../src/ShaderWatcher.h"
 #include "../../src/make_absolute_path.h"
 #include "../../src/math.h"
 #include "../../src/math_constants.h"
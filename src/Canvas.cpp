@@ -1,8 +1,8 @@
 #include "Canvas.h"
-#include <img/img.hpp>
-#include "internal/append_number_if_file_already_exists.h"
-#include "internal/make_directories_if_necessary.h"
-#include "make_absolute_path.h"
+#include <stdexcept>
+#include "internal/ImageSaver.h"
+#include "internal/PixelReadback.h"
+#include "internal/flush_pending_draws.h"
 
 namespace p6 {
 
@@ -10,29 +10,38 @@ Canvas::Canvas(ImageSize size, glpp::TextureLayout texture_layout)
     : _render_target{size, nullptr, texture_layout, true}
 {}
 
-void save_image(const Canvas& canvas, std::filesystem::path path)
+std::future<std::filesystem::path> save_image(const Canvas& canvas, std::filesystem::path path)
 {
-    const auto automatically_restore_previous_bindings_at_end_of_scope = glpp::RenderTargetBindState_RAII{};
-    canvas.render_target().bind();
-    const auto                 width  = static_cast<img::Size::DataType>(canvas.size().width());
-    const auto                 height = static_cast<img::Size::DataType>(canvas.size().height());
-    std::unique_ptr<uint8_t[]> data{new uint8_t[4 * width * height]};
-    glReadPixels(0, 0, static_cast<GLsizei>(width), static_cast<GLsizei>(height), GL_RGBA, GL_UNSIGNED_BYTE, data.get());
-    const auto absolute_path = internal::append_number_if_file_already_exists(make_absolute_path(path));
-    internal::make_directories_if_necessary(absolute_path);
-    if (path.extension() == ".png")
-    {
-        img::save_png(absolute_path.string().c_str(), width, height, data.get(), 4);
-    }
-    else if (path.extension() == ".jpg"
-             || path.extension() == ".jpeg")
-    {
-        img::save_jpeg(absolute_path.string().c_str(), width, height, data.get(), 4);
-    }
-    else
-    {
-        throw std::runtime_error{"[p6::save_image] Only supports .png, .jpeg and .jpg extensions"};
-    }
+    internal::flush_pending_draws(); // The batched shapes must be on the canvas before we read it
+    return internal::ImageSaver::instance().save(canvas, std::move(path));
+}
+
+PixelsFuture::PixelsFuture()
+    : _readback{std::make_unique<internal::PixelReadback>()}
+{}
+
+PixelsFuture::~PixelsFuture()                                  = default;
+PixelsFuture::PixelsFuture(PixelsFuture&&) noexcept            = default;
+PixelsFuture& PixelsFuture::operator=(PixelsFuture&&) noexcept = default;
+
+bool PixelsFuture::is_ready() const
+{
+    return _readback && _readback->is_ready();
+}
+
+Pixels PixelsFuture::get()
+{
+    if (!_readback || !_readback->is_pending())
+        throw std::runtime_error{"[p6::PixelsFuture::get] The pixels have already been retrieved."};
+    auto data = _readback->finish();
+    return Pixels{_readback->size(), std::move(data)};
+}
+
+PixelsFuture read_pixels_async(const Canvas& canvas)
+{
+    auto future = PixelsFuture{};
+    future._readback->start(canvas);
+    return future;
 }
 
 } // namespace p6
\ No newline at end of file
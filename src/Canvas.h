@@ -1,10 +1,18 @@
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
+#include <future>
+#include <memory>
+#include <vector>
 #include "ImageCommon.h"
 
 namespace p6 {
 
+namespace internal {
+class PixelReadback;
+}
+
 /// \ingroup canvas
 /// A canvas is an image that can be drawn onto.
 class Canvas : public ImageOrCanvas {
@@ -40,11 +48,69 @@ private:
 
 /// \ingroup canvas
 /// Saves the content of the canvas as an image file.
-/// Supported file types are .png and .jpeg/.jpg
+/// Supported file types are:
+/// - .png and .jpeg/.jpg
+/// - .qoi: lossless like .png, but many times faster to encode
+/// - .ppm and .rgba: uncompressed RGB / RGBA values, nearly free to write
+/// - .exr: half-float, which keeps the full precision of the canvas instead of truncating it to 8 bits
 /// Simply use the corresponding extension to save in the desired format.
 /// If the path already exists, a number will be appended to the name and the previous file won't be overwritten.
 /// If the path is relative, it will be relative to the directory containing your executable.
 /// If some directories in the path don't exist yet, they will be created automatically.
-void save_image(const Canvas& canvas, std::filesystem::path path);
+/// The image is saved in the background: this returns immediately, and the returned future gives you the path the file has actually been written to, once it is done.
+/// If many images are already waiting to be encoded, this waits until there is room for the new one.
+/// All the images are done saving when the Context is destroyed.
+/// :warning: The pixels only reach the encoders once the Context has moved on to the next frames, so don't wait on the future inside the frame that saved the image.
+std::future<std::filesystem::path> save_image(const Canvas& canvas, std::filesystem::path path);
+
+/// \ingroup canvas
+/// The pixels of a canvas, as RGBA 8-bit, with the rows ordered from bottom to top (like OpenGL does).
+struct Pixels {
+    ImageSize            size{0, 0};
+    std::vector<uint8_t> data{};
+};
+
+/// \ingroup canvas
+/// The pixels of a canvas that are being read by read_pixels_async(). They usually arrive one or two frames later.
+/// :warning: It must be used and destroyed on the thread that owns the OpenGL context, while the Context is still alive.
+class PixelsFuture {
+public:
+    ~PixelsFuture();
+    PixelsFuture(PixelsFuture&&) noexcept;
+    PixelsFuture& operator=(PixelsFuture&&) noexcept;
+    PixelsFuture(const PixelsFuture&)            = delete;
+    PixelsFuture& operator=(const PixelsFuture&) = delete;
+
+    /// Returns true iff the pixels have arrived, i.e. get() won't block.
+    bool is_ready() const;
+    /// Returns the pixels. Blocks until they have arrived if necessary.
+    /// :warning: Can only be called once.
+    Pixels get();
+
+private:
+    friend PixelsFuture read_pixels_async(const Canvas& canvas);
+    PixelsFuture();
+
+private:
+    std::unique_ptr<internal::PixelReadback> _readback;
+};
+
+/// \ingroup canvas
+/// Starts reading the pixels of the canvas, without waiting for the GPU to be done rendering them (which is what makes glReadPixels so slow).
+/// Check is_ready() on the returned object during the next frames, and call get() once it is.
+///
+/// ```
+/// auto pixels = std::optional<p6::PixelsFuture>{};
+/// ctx.update = [&]() {
+///     if (!pixels)
+///         pixels = p6::read_pixels_async(ctx.main_canvas());
+///     else if (pixels->is_ready())
+///     {
+///         analyse(pixels->get());
+///         pixels.reset();
+///     }
+/// };
+/// ```
+PixelsFuture read_pixels_async(const Canvas& canvas);
 
 } // namespace p6
\ No newline at end of file
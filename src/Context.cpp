@@ -1,11 +1,18 @@
 #include "Context.h"
+#include <algorithm>
 #include <cstdint>
+#include <cstdlib>
 #include <glm/gtx/matrix_transform_2d.hpp>
 #include <glm/gtx/vector_angle.hpp>
 #include <img/img.hpp>
+#include <limits>
 #include <stdexcept>
 #include <string>
 #include "GLFW/glfw3.h"
+#include "ShaderWatcher.h"
+#include "internal/ImageLoader.h"
+#include "internal/ImageSaver.h"
+#include "internal/flush_pending_draws.h"
 #include "math.h"
 
 namespace p6 {
@@ -36,7 +43,8 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 }
 
 Context::Context(WindowCreationParams window_creation_params)
-    : _window{window_creation_params}
+    : _is_headless{window_creation_params.headless}
+    , _window{window_creation_params}
     , _window_size{window_creation_params.width,
                    window_creation_params.height}
     , _window_width_before_fullscreen{window_creation_params.width}
@@ -45,6 +53,12 @@ Context::Context(WindowCreationParams window_creation_params)
     glpp::set_error_callback([&](std::string&& error_message) { // TODO glpp's error callback is global while on_error is tied to a context. This means that if we create two Contexts glpp will only use the error callback of the second Context.
         on_error(std::move(error_message));
     });
+    internal::set_flush_pending_draws_callback([&]() {
+        flush();
+    });
+    internal::ImageLoader::instance().set_image_decoded_callback([&]() {
+        _frame_pacer.request_frame(); // So that the image gets displayed even in render_on_demand() mode
+    });
     glfwSetWindowUserPointer(*_window, this);
     glfwSetWindowSizeCallback(*_window, &window_size_callback);
     glfwSetFramebufferSizeCallback(*_window, &framebuffer_size_callback);
@@ -57,7 +71,8 @@ Context::Context(WindowCreationParams window_creation_params)
         on_framebuffer_resize(width, height);
     }
 
-    _imgui_wrapper.emplace(*_window, window_creation_params.imgui_config_flags); // Must be after all the glfwSetXxxCallback, otherwise they will override the ImGui callbacks
+    if (!_is_headless) // There is nobody to interact with the UI
+        _imgui_wrapper.emplace(*_window, window_creation_params.imgui_config_flags); // Must be after all the glfwSetXxxCallback, otherwise they will override the ImGui callbacks
 
 #ifndef P6_RAW_OPENGL_MODE
     render_to_main_canvas();
@@ -67,20 +82,13 @@ Context::Context(WindowCreationParams window_creation_params)
 
 Context::~Context()
 {
+    _recorder.reset(); // Reads back the last frames, so it must be done while everything is still alive
+    internal::ImageSaver::instance().finish();
+    internal::ImageLoader::instance().set_image_decoded_callback({});
+    internal::set_flush_pending_draws_callback({});
     glpp::shut_down();
 }
 
-static bool needs_to_wait_to_cap_framerate(std::optional<std::chrono::nanoseconds> capped_delta_time,
-                                           std::chrono::steady_clock::time_point   last_update)
-{
-    if (!capped_delta_time)
-    {
-        return false;
-    }
-    const auto delta_time = std::chrono::steady_clock::now() - last_update;
-    return delta_time < *capped_delta_time;
-}
-
 static bool skip_first_frames(internal::Clock& clock)
 {
     static int frame_count = 0;
@@ -121,17 +129,66 @@ glm::mat3 Context::complete_transform_matrix(const Transform2D& transform) const
     return _transform_stack.current_matrix() * as_matrix(transform);
 }
 
+void Context::begin_frame()
+{
+    opengl_state_has_changed(); // ImGui and the user's raw OpenGL calls from the previous frame might have changed it
+    internal::start_compiling_pending_shaders();
+    internal::update_shader_watchers(); // Swap the shaders that have been reloaded now, so that they don't change in the middle of a frame
+    if (internal::ImageLoader::instance().upload_decoded_images(_images_upload_budget))
+        _frame_pacer.request_frame(); // Upload the remaining images during the next frames
+}
+
+void Context::update_once()
+{
+    _clock->update();
+    _frame_pacer.frame_has_started();
+    _main_canvas_cpu_copy_is_outdated = true;
+    update_frame_data(); // So that it is up to date even for shaders that are used with raw OpenGL calls
+    update();
+    on_event(Event_Update{});
+}
+
+void Context::render_frame()
+{
+    begin_frame();
+#ifndef P6_RAW_OPENGL_MODE
+    render_to_main_canvas();
+#endif
+    update_once();
+    flush();
+#ifndef P6_RAW_OPENGL_MODE
+    if (_recorder)
+        _recorder->capture(_main_canvas);
+#endif
+    _streaming_buffer.end_frame();
+    _path_renderer.end_frame();
+    internal::ImageSaver::instance().update();
+}
+
 void Context::start()
 {
+    if (_is_headless) // Nothing to display and no events to wait for, so we just render as fast as possible
+    {
+        while (!glfwWindowShouldClose(*_window))
+        {
+            if (is_paused())
+            {
+                glfwWaitEventsTimeout(0.1); // Nothing to update, so don't spin. We still wake up regularly, because resume() can be called from another thread.
+                continue;
+            }
+            render_frame();
+        }
+        glfwSetWindowShouldClose(*_window, GLFW_FALSE);
+        return;
+    }
     while (!glfwWindowShouldClose(*_window))
     {
         if (!glfwGetWindowAttrib(*_window, GLFW_ICONIFIED)) // Do nothing while the window is minimized. This is here partly because we don't have a proper notion of a window with size 0 and it would currently crash.
         {
-#if P6_RAW_OPENGL_MODE
             bool has_updated_this_frame = false;
-#endif
             if (!skip_first_frames(*_clock)) // Allow the clock to compute its delta_time() properly
             {
+                begin_frame();
                 _imgui_wrapper->begin_frame();
 #ifndef P6_RAW_OPENGL_MODE
                 // Clear the window in case the default canvas doesn't cover the whole window
@@ -144,16 +201,19 @@ void Context::start()
                 check_for_mouse_movements();
 
                 if (!is_paused()
-                    && !needs_to_wait_to_cap_framerate(_capped_delta_time, _last_update))
+                    && _frame_pacer.is_time_for_next_frame())
                 {
-                    _clock->update();
-                    _last_update = std::chrono::steady_clock::now();
-                    update();
-                    on_event(Event_Update{});
-#if P6_RAW_OPENGL_MODE
+                    update_once();
                     has_updated_this_frame = true;
-#endif
                 }
+                flush();
+#ifndef P6_RAW_OPENGL_MODE
+                if (_recorder && has_updated_this_frame) // Only record new frames
+                    _recorder->capture(_main_canvas);
+#endif
+                _streaming_buffer.end_frame();
+                _path_renderer.end_frame();
+                internal::ImageSaver::instance().update();
 #ifndef P6_RAW_OPENGL_MODE
                 {
                     const auto size_inside_window = main_canvas_displayed_size_inside_window();
@@ -177,7 +237,7 @@ void Context::start()
             render_to_main_canvas();
 #endif
         }
-        glfwPollEvents();
+        _frame_pacer.wait_for_next_frame(*_window); // Processes the events, and sleeps if the framerate is capped
     }
     glfwSetWindowShouldClose(*_window, GLFW_FALSE); // Make sure that if start() is called a second time the window won't close instantly the second time
 }
@@ -188,6 +248,7 @@ void Context::start()
 
 void Context::background(Color color)
 {
+    flush();
     glClearColor(color.r(), color.g(), color.b(), color.a());
     glClear(GL_COLOR_BUFFER_BIT);
 }
@@ -254,7 +315,7 @@ void Context::rectangle(BottomRightCorner corner, Radii radii, Rotation rotation
 
 void Context::rectangle(Transform2D transform)
 {
-    render_with_rect_shader(transform, false, false);
+    add_to_rect_batch(transform, false);
 }
 
 void Context::circle(FullScreen)
@@ -279,7 +340,7 @@ void Context::ellipse(Center center, Radii radii, Rotation rotation)
 
 void Context::ellipse(Transform2D transform)
 {
-    render_with_rect_shader(transform, true, false);
+    add_to_rect_batch(transform, true);
 }
 
 void Context::equilateral_triangle(Center center, Radius radius, Rotation rotation)
@@ -295,17 +356,35 @@ void Context::triangle(Point2D p1, Point2D p2, Point2D p3, Center center, Rotati
 
 void Context::triangle(Point2D p1, Point2D p2, Point2D p3, Transform2D transform)
 {
-    _triangle_renderer.render(p1.value, p2.value, p3.value,
-                              complete_transform_matrix(transform),
-#ifndef P6_RAW_OPENGL_MODE
-                              static_cast<float>(current_canvas_height()),
-#else
-                              static_cast<float>(main_canvas_height()),
-#endif
-                              aspect_ratio(),
-                              use_fill ? std::make_optional(fill.as_premultiplied_vec4()) : std::nullopt,
-                              use_stroke ? std::make_optional(stroke.as_premultiplied_vec4()) : std::nullopt,
-                              stroke_weight);
+    add_to_triangle_batch(p1.value, p2.value, p3.value, complete_transform_matrix(transform));
+}
+
+void Context::triangles(std::vector<glm::vec2> const& points)
+{
+    const auto matrix = _transform_stack.current_matrix();
+    for (size_t i = 0; i + 2 < points.size(); i += 3)
+        add_to_triangle_batch(points[i], points[i + 1], points[i + 2], matrix);
+}
+
+void Context::points(std::vector<glm::vec2> const& positions, std::vector<float> const& radii, std::vector<Color> const& colors)
+{
+    const auto check_size = [&](size_t size, const char* name) {
+        if (size != 1 && size != positions.size())
+            throw std::runtime_error{"[p6::Context::points] " + std::string{name} + " must contain either one value, or as many values as there are positions (" + std::to_string(positions.size()) + "), but it contains " + std::to_string(size) + "."};
+    };
+    check_size(radii.size(), "radii");
+    if (!colors.empty())
+        check_size(colors.size(), "colors");
+    if (colors.empty() && !use_fill)
+        return;
+
+    flush();
+    update_frame_data();
+    const auto fill_only = std::vector<Color>{fill};
+    _point_renderer.render(positions, radii,
+                           colors.empty() ? fill_only : colors, // Both branches are lvalues, so this doesn't copy `colors`
+                           complete_transform_matrix({}),
+                           _opengl_state, _streaming_buffer);
 }
 
 static Radii make_radii(RadiusX radiusX, float aspect_ratio)
@@ -456,10 +535,9 @@ void Context::image(const ImageOrCanvas& img, BottomRightCorner corner, Radii ra
 
 void Context::image(const ImageOrCanvas& img, Transform2D transform)
 {
+    flush();
     img.texture().bind_to_texture_unit(0);
-    _rect_shader.use();
-    _rect_shader.set("_image", 0);
-    render_with_rect_shader(transform, false, true);
+    render_with_image_shader(transform);
 }
 
 void Context::set_vertex_shader_uniforms(const Shader& shader, Transform2D transform) const
@@ -503,6 +581,12 @@ void Context::text(const std::u16string& str, BottomRightCorner corner, Rotation
     text_impl(*this, _text_renderer, str, corner, rotation);
 }
 
+void Context::text(const std::u16string& str, Transform2D transform)
+{
+    _text_renderer.setup_rendering_for(str, fill, text_inflating);
+    rectangle_with_shader(_text_renderer.shader(), transform);
+}
+
 void Context::rectangle_with_shader(const Shader& shader, FullScreen)
 {
     rectangle_with_shader(shader, make_transform_2D(FullScreen{}));
@@ -560,14 +644,16 @@ void Context::square_with_shader(const Shader& shader, BottomRightCorner corner,
 
 void Context::rectangle_with_shader(const Shader& shader, Transform2D transform)
 {
+    flush();
+    update_frame_data();
     set_vertex_shader_uniforms(shader, transform);
     shader.check_for_errors_before_rendering();
-    _rect_renderer.render();
+    _rect_renderer.render(_opengl_state);
 }
 
 void Context::line(glm::vec2 start, glm::vec2 end)
 {
-    _line_shader.set("_material", stroke.as_premultiplied_vec4());
+    _line_shader.set(_line_shader_material, stroke.as_premultiplied_vec4());
     rectangle_with_shader(_line_shader,
                           Center{(start + end) / 2.f},
                           Radii{glm::distance(start, end) / 2.f + stroke_weight, stroke_weight},
@@ -575,21 +661,178 @@ void Context::line(glm::vec2 start, glm::vec2 end)
                                                               glm::normalize(end - start))}});
 }
 
-void Context::render_with_rect_shader(Transform2D transform, bool is_ellipse, bool is_image) const
+internal::PolylineStyle Context::polyline_style() const
+{
+    return {stroke_weight, line_join, line_cap};
+}
+
+void Context::polyline(std::vector<glm::vec2> const& points)
+{
+    _tessellated_vertices.clear();
+    internal::tessellate_polyline(points, false, polyline_style(), _tessellated_vertices);
+    flush();
+    update_frame_data();
+    _path_renderer.render(_tessellated_vertices, complete_transform_matrix({}), stroke.as_premultiplied_vec4(), _opengl_state, _streaming_buffer);
+}
+
+void Context::path(Path const& path)
+{
+    flush();
+    update_frame_data();
+    _path_renderer.render(path, polyline_style(), complete_transform_matrix({}), stroke.as_premultiplied_vec4(), _opengl_state);
+}
+
+void Context::render_with_image_shader(Transform2D transform) const
+{
+    update_frame_data();
+    _image_shader.use();
+    set_vertex_shader_uniforms(_image_shader, transform);
+    _image_shader.set(_image_shader_image, 0);
+    _image_shader.check_for_errors_before_rendering();
+    _rect_renderer.render(_opengl_state);
+}
+
+void Context::add_to_rect_batch(Transform2D transform, bool is_ellipse)
+{
+    _triangle_batch_renderer.flush(_opengl_state, _streaming_buffer); // Only one batch can be open at a time, otherwise the shapes would not be drawn in the order they were requested
+    if (_rect_batch_renderer.is_empty()) // The frame data can't change while there are shapes in the batch, because we flush whenever it could (canvas change, new frame, etc.)
+        update_frame_data();
+    const auto matrix = complete_transform_matrix(transform);
+    _rect_batch_renderer.push(internal::RectInstance{
+                                  matrix,
+                                  internal::get_scale(matrix),
+                                  use_fill ? fill.as_premultiplied_vec4() : glm::vec4{0.f},
+                                  stroke.as_premultiplied_vec4(),
+                                  stroke_weight,
+                                  is_ellipse ? 1.f : 0.f,
+                                  use_stroke ? 1.f : 0.f,
+                              },
+                              _opengl_state, _streaming_buffer);
+}
+
+static glm::vec2 apply(glm::mat3 const& matrix, glm::vec2 point)
+{
+    auto const tmp = matrix * glm::vec3(point.x, point.y, 1.);
+    return glm::vec2(tmp.x, tmp.y) / tmp.z;
+}
+
+void Context::add_to_triangle_batch(glm::vec2 p1, glm::vec2 p2, glm::vec2 p3, glm::mat3 const& transform)
+{
+    if (!use_fill && !use_stroke)
+        return;
+    _rect_batch_renderer.flush(_opengl_state, _streaming_buffer); // Only one batch can be open at a time, otherwise the shapes would not be drawn in the order they were requested
+    if (_triangle_batch_renderer.is_empty()) // The frame data can't change while there are shapes in the batch, because we flush whenever it could (canvas change, new frame, etc.)
+        update_frame_data();
+    const auto fill_color = use_fill ? fill.as_premultiplied_vec4() : glm::vec4{0.f};
+    _triangle_batch_renderer.push(apply(transform, p1), apply(transform, p2), apply(transform, p3),
+                                  fill_color,
+                                  use_stroke ? stroke.as_premultiplied_vec4() : fill_color,
+                                  stroke_weight,
+                                  _opengl_state, _streaming_buffer);
+}
+
+void Context::flush() const
+{
+    _rect_batch_renderer.flush(_opengl_state, _streaming_buffer);
+    _triangle_batch_renderer.flush(_opengl_state, _streaming_buffer);
+    _main_canvas_cpu_copy_is_outdated = true; // Everything that draws calls flush() first, and so do the users that draw with raw OpenGL
+}
+
+void Context::opengl_state_has_changed() const
+{
+    _opengl_state.invalidate();
+    internal::forget_currently_used_program();
+    _frame_data_buffer.invalidate();
+}
+
+void Context::update_frame_data() const
+{
+#ifndef P6_RAW_OPENGL_MODE
+    const auto canvas_size = current_canvas_size();
+#else
+    const auto canvas_size = _framebuffer_size;
+#endif
+    _frame_data_buffer.upload(internal::FrameData{
+        glm::vec2{static_cast<float>(canvas_size.width()), static_cast<float>(canvas_size.height())},
+        canvas_size.aspect_ratio(),
+        canvas_size.inverse_aspect_ratio(),
+        mouse(),
+        time(),
+        delta_time(),
+    });
+}
+
+void Context::replay(const DrawList& draw_list)
+{
+    const auto fill_backup           = fill;
+    const auto use_fill_backup       = use_fill;
+    const auto stroke_backup         = stroke;
+    const auto stroke_weight_backup  = stroke_weight;
+    const auto use_stroke_backup     = use_stroke;
+    const auto text_inflating_backup = text_inflating;
+
+    for (auto const& command : draw_list.commands())
+    {
+        fill           = command.fill;
+        use_fill       = command.use_fill;
+        stroke         = command.stroke;
+        stroke_weight  = command.stroke_weight;
+        use_stroke     = command.use_stroke;
+        text_inflating = command.text_inflating;
+        switch (command.kind)
+        {
+        case internal::DrawCommandKind::Rectangle:
+            rectangle(command.transform);
+            break;
+        case internal::DrawCommandKind::Ellipse:
+            ellipse(command.transform);
+            break;
+        case internal::DrawCommandKind::Triangle:
+            triangle(command.points[0], command.points[1], command.points[2], command.transform);
+            break;
+        case internal::DrawCommandKind::Line:
+            line(command.points[0], command.points[1]);
+            break;
+        case internal::DrawCommandKind::Image:
+            image(*command.image, command.transform);
+            break;
+        case internal::DrawCommandKind::Text:
+            text(draw_list.text_of(command), command.transform);
+            break;
+        }
+    }
+
+    fill           = fill_backup;
+    use_fill       = use_fill_backup;
+    stroke         = stroke_backup;
+    stroke_weight  = stroke_weight_backup;
+    use_stroke     = use_stroke_backup;
+    text_inflating = text_inflating_backup;
+}
+
+void Context::replay(const ParallelDrawLists& draw_lists)
+{
+    for (auto const& [key, draw_list] : draw_lists.lists())
+        replay(draw_list);
+}
+
+#ifndef P6_RAW_OPENGL_MODE
+void Context::replay(const DrawList& draw_list, Canvas& canvas)
+{
+    auto& previous_canvas = current_canvas();
+    render_to_canvas(canvas);
+    replay(draw_list);
+    render_to_canvas(previous_canvas);
+}
+
+void Context::replay(const ParallelDrawLists& draw_lists, Canvas& canvas)
 {
-    _rect_shader.use();
-    set_vertex_shader_uniforms(_rect_shader, transform);
-    _rect_shader.set("_is_image", is_image);
-    if (!is_image)
-        _rect_shader.set("_image", 0); // Prevents warning from check_for_errors_before_rendering() if uniform is not set
-    _rect_shader.set("_is_ellipse", is_ellipse);
-    _rect_shader.set("_fill_color", use_fill ? fill.as_premultiplied_vec4() : glm::vec4{0.f});
-    _rect_shader.set("_stroke_color", stroke.as_premultiplied_vec4());
-    _rect_shader.set("_use_stroke", use_stroke);
-    _rect_shader.set("_stroke_weight", stroke_weight);
-    _rect_shader.check_for_errors_before_rendering();
-    _rect_renderer.render();
+    auto& previous_canvas = current_canvas();
+    render_to_canvas(canvas);
+    replay(draw_lists);
+    render_to_canvas(previous_canvas);
 }
+#endif
 
 /* -------------------------------- *
  * ---------RENDER TARGETS--------- *
@@ -598,6 +841,7 @@ void Context::render_with_rect_shader(Transform2D transform, bool is_ellipse, bo
 #ifndef P6_RAW_OPENGL_MODE
 void Context::render_to_canvas(Canvas& canvas)
 {
+    flush();
     canvas.render_target().bind();
     _current_canvas = canvas;
 }
@@ -758,7 +1002,7 @@ int Context::current_canvas_height() const
 }
 #endif
 
-Color Context::read_pixel(glm::vec2 position) const
+glm::ivec2 Context::main_canvas_pixel_coordinates(glm::vec2 position) const
 {
     const auto x = static_cast<int>(p6::map(position.x,
                                             -main_canvas_size().aspect_ratio(), +main_canvas_size().aspect_ratio(),
@@ -766,20 +1010,108 @@ Color Context::read_pixel(glm::vec2 position) const
     const auto y = static_cast<int>(p6::map(position.y,
                                             -1.f, +1.f,
                                             0.f, static_cast<float>(main_canvas_height())));
-    uint8_t    channels[4];
+    return {std::clamp(x, 0, main_canvas_width() - 1),
+            std::clamp(y, 0, main_canvas_height() - 1)};
+}
+
+Pixels Context::read_main_canvas_pixels(glm::ivec2 bottom_left_corner, ImageSize size) const
+{
+    auto pixels = Pixels{size, std::vector<uint8_t>(4 * static_cast<size_t>(size.width()) * static_cast<size_t>(size.height()))};
+    flush();
 #ifndef P6_RAW_OPENGL_MODE
     GLint previous_framebuffer;
     glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previous_framebuffer);
     glpp::bind_framebuffer_as_read(main_canvas().render_target().framebuffer());
 #endif
-    glReadPixels(x, y, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, channels);
+    glReadPixels(bottom_left_corner.x, bottom_left_corner.y, size.width(), size.height(), GL_RGBA, GL_UNSIGNED_BYTE, pixels.data.data());
 #ifndef P6_RAW_OPENGL_MODE
     glpp::bind_framebuffer_as_read(static_cast<GLuint>(previous_framebuffer));
 #endif
-    return p6::Color{static_cast<float>(channels[0]) / 255.f,
-                     static_cast<float>(channels[1]) / 255.f,
-                     static_cast<float>(channels[2]) / 255.f,
-                     static_cast<float>(channels[3]) / 255.f};
+    return pixels;
+}
+
+Pixels const& Context::main_canvas_cpu_copy() const
+{
+    if (!_rect_batch_renderer.is_empty() || !_triangle_batch_renderer.is_empty())
+        flush();
+    if (_main_canvas_cpu_copy_is_outdated)
+    {
+        _main_canvas_cpu_copy             = read_main_canvas_pixels({0, 0}, main_canvas_size());
+        _main_canvas_cpu_copy_is_outdated = false; // Must be after read_main_canvas_pixels(), because it flushes
+    }
+    return _main_canvas_cpu_copy;
+}
+
+void Context::keep_cpu_copy_of_main_canvas(bool keep)
+{
+    _keeps_cpu_copy_of_main_canvas = keep;
+    if (!keep)
+        _main_canvas_cpu_copy = {}; // Free the memory
+    _main_canvas_cpu_copy_is_outdated = true;
+}
+
+static auto color_from_rgba8(uint8_t const* channels) -> Color
+{
+    return p6::Color{static_cast<float>(channels[0]) / 255.f,  // NOLINT(*-pointer-arithmetic)
+                     static_cast<float>(channels[1]) / 255.f,  // NOLINT(*-pointer-arithmetic)
+                     static_cast<float>(channels[2]) / 255.f,  // NOLINT(*-pointer-arithmetic)
+                     static_cast<float>(channels[3]) / 255.f}; // NOLINT(*-pointer-arithmetic)
+}
+
+Color Context::read_pixel(glm::vec2 position) const
+{
+    return read_pixels({position})[0];
+}
+
+std::vector<Color> Context::read_pixels(std::vector<glm::vec2> const& positions) const
+{
+    auto colors = std::vector<Color>{};
+    if (positions.empty())
+        return colors;
+    colors.reserve(positions.size());
+
+    auto coordinates = std::vector<glm::ivec2>{};
+    coordinates.reserve(positions.size());
+    auto min = glm::ivec2{std::numeric_limits<int>::max()};
+    auto max = glm::ivec2{std::numeric_limits<int>::min()};
+    for (auto const& position : positions)
+    {
+        coordinates.push_back(main_canvas_pixel_coordinates(position));
+        min = glm::min(min, coordinates.back());
+        max = glm::max(max, coordinates.back());
+    }
+
+    // Read all the pixels at once: either from the CPU copy, or with a single readback of the smallest rectangle that contains them all
+    const auto region = _keeps_cpu_copy_of_main_canvas ? std::optional<Pixels>{}
+                                                       : read_main_canvas_pixels(min, ImageSize{max.x - min.x + 1, max.y - min.y + 1});
+    const auto& pixels = region ? *region : main_canvas_cpu_copy();
+    const auto  origin = region ? min : glm::ivec2{0};
+    for (auto const& coords : coordinates)
+    {
+        const auto index = 4 * (static_cast<size_t>(coords.y - origin.y) * static_cast<size_t>(pixels.size.width()) + static_cast<size_t>(coords.x - origin.x));
+        colors.push_back(color_from_rgba8(&pixels.data[index]));
+    }
+    return colors;
+}
+
+Pixels Context::read_region(glm::vec2 corner, glm::vec2 opposite_corner) const
+{
+    const auto coords1 = main_canvas_pixel_coordinates(corner);
+    const auto coords2 = main_canvas_pixel_coordinates(opposite_corner);
+    const auto min     = glm::min(coords1, coords2);
+    const auto size    = ImageSize{std::abs(coords2.x - coords1.x) + 1, std::abs(coords2.y - coords1.y) + 1};
+    if (!_keeps_cpu_copy_of_main_canvas)
+        return read_main_canvas_pixels(min, size);
+
+    auto const& copy     = main_canvas_cpu_copy();
+    auto        region   = Pixels{size, std::vector<uint8_t>(4 * static_cast<size_t>(size.width()) * static_cast<size_t>(size.height()))};
+    const auto  row_size = 4 * static_cast<size_t>(size.width());
+    for (GLsizei y = 0; y < size.height(); ++y)
+    {
+        const auto src_offset = 4 * (static_cast<size_t>(min.y + y) * static_cast<size_t>(copy.size.width()) + static_cast<size_t>(min.x));
+        std::copy_n(copy.data.begin() + static_cast<std::ptrdiff_t>(src_offset), row_size, region.data.begin() + static_cast<std::ptrdiff_t>(static_cast<size_t>(y) * row_size));
+    }
+    return region;
 }
 
 bool Context::window_is_focused() const
@@ -908,6 +1240,23 @@ float Context::delta_time() const
     return _clock->delta_time();
 }
 
+#ifndef P6_RAW_OPENGL_MODE
+void Context::start_recording(std::filesystem::path const& path, float framerate, RecordingFormat format)
+{
+    _recorder.reset(); // Finish the previous recording first
+    _recorder = std::make_unique<internal::Recorder>(path, framerate, format);
+    time_perceived_as_constant_delta_time(framerate);
+}
+
+void Context::stop_recording()
+{
+    if (!_recorder)
+        return;
+    _recorder.reset();
+    time_perceived_as_realtime();
+}
+#endif
+
 void Context::time_perceived_as_realtime()
 {
     const auto t          = _clock->time();
@@ -935,21 +1284,42 @@ void Context::time_perceived_as_constant_delta_time(float framerate)
 void Context::framerate_synced_with_monitor()
 {
     glfwSwapInterval(1);
-    _capped_delta_time.reset();
+    _frame_pacer.set_target_frame_duration(std::nullopt);
+    _frame_pacer.set_render_on_demand(false);
 }
 
 void Context::framerate_as_high_as_possible()
 {
     glfwSwapInterval(0);
-    _capped_delta_time.reset();
+    _frame_pacer.set_target_frame_duration(std::nullopt);
+    _frame_pacer.set_render_on_demand(false);
 }
 
 void Context::framerate_capped_at(float framerate)
 {
     glfwSwapInterval(0);
-    _capped_delta_time = std::chrono::nanoseconds{static_cast<std::chrono::nanoseconds::rep>(
+    _frame_pacer.set_target_frame_duration(std::chrono::nanoseconds{static_cast<std::chrono::nanoseconds::rep>(
         1'000'000'000.f / framerate // Convert from fps to nanoseconds
-        )};
+        )});
+    _frame_pacer.set_render_on_demand(false);
+}
+
+void Context::render_on_demand()
+{
+    glfwSwapInterval(1);
+    _frame_pacer.set_target_frame_duration(std::nullopt);
+    _frame_pacer.set_render_on_demand(true);
+}
+
+void Context::request_redraw()
+{
+    _frame_pacer.request_frame();
+}
+
+void Context::request_redraw_in(float delay)
+{
+    _frame_pacer.request_frame_at(internal::FramePacer::clock::now()
+                                  + std::chrono::duration_cast<internal::FramePacer::clock::duration>(std::chrono::duration<float>{delay}));
 }
 
 /* ------------------------------- *
@@ -1037,6 +1407,7 @@ static void adapt_canvas_size_to_framebuffer_size(Canvas& canvas, ImageSize size
 #ifndef P6_RAW_OPENGL_MODE
 void Context::adapt_main_canvas_size_to_framebuffer_size()
 {
+    flush();
     std::visit([&](auto&& mode) { internal::adapt_canvas_size_to_framebuffer_size(_main_canvas, _framebuffer_size, mode); }, _main_canvas_size_mode);
     main_canvas_resized();
     on_event(Event_MainCanvasResized{});
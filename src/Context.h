@@ -11,18 +11,28 @@
 #include <stdexcept>
 #include "Canvas.h"
 #include "Color.h"
+#include "DrawList.h"
 #include "Event.h"
 #include "Image.h"
+#include "Path.h"
 #include "Shader.h"
 #include "Transform2D.h"
+#include "internal/FrameData.h"
 #include "internal/ImGuiWrapper.h"
+#include "internal/OpenGLStateTracker.h"
+#include "internal/PathRenderer.h"
+#include "internal/PointRenderer.h"
+#include "internal/Recorder.h"
+#include "internal/RectBatchRenderer.h"
 #include "internal/RectRenderer.h"
+#include "internal/StreamingBuffer.h"
 #include "internal/TextRenderer.h"
 #include "internal/Time/Clock.h"
 #include "internal/Time/Clock_FixedTimestep.h"
 #include "internal/Time/Clock_Realtime.h"
+#include "internal/Time/FramePacer.h"
 #include "internal/TransformStack.h"
-#include "internal/TriangleRenderer.h"
+#include "internal/TriangleBatchRenderer.h"
 #include "internal/UniqueGlfwWindow.h"
 
 namespace p6 {
@@ -32,16 +42,6 @@ struct Fit {};
 struct FitX {};
 struct FitY {};
 
-struct Point2D {
-    glm::vec2 value;
-
-    Point2D(float x, float y)
-        : value{x, y} {}
-
-    Point2D(glm::vec2 value)
-        : value{value} {}
-};
-
 /// The canvas will have the same size as the window's framebuffer
 struct CanvasSizeMode_SameAsWindow {};
 
@@ -187,6 +187,10 @@ public:
     float stroke_weight = 0.01f;
     /// Whether there will be a boundary on the shape.
     bool use_stroke = true;
+    /// How the segments of polylines and paths are connected.
+    LineJoin line_join = LineJoin::Round;
+    /// How the ends of polylines and paths look like.
+    LineCap line_cap = LineCap::Round;
 
     /// Sets the color and alpha of each pixel of the canvas.
     /// NB: No blending is applied; even if you specify an alpha of 0.5 the old canvas is completely erased. This means that setting an alpha here doesn't matter much. It is only meaningful if you export the canvas as a png, or if you later try to blend the canvas on top of another image.
@@ -224,6 +228,14 @@ public:
     void triangle(Point2D, Point2D, Point2D, Center = {}, Rotation = {});
     /// Draws a triangle between the three points, and applies the transform to the triangle.
     void triangle(Point2D, Point2D, Point2D, Transform2D);
+    /// Draws many triangles at once: every three consecutive points form one triangle (a trailing incomplete triangle is ignored).
+    /// All the triangles use the current style and transform, and are rendered with a single draw call, which makes it the fastest way to draw a mesh.
+    void triangles(std::vector<glm::vec2> const& points);
+
+    /// Draws a disc at each of the positions, all at once. This is the fastest way to draw particles.
+    /// `radii` and `colors` must either contain one value per position, or a single value that is then used for all the points. If `colors` is empty, `fill` is used, and nothing is drawn if `use_fill` is false.
+    /// The arrays are sent to the GPU as-is, so keeping your particles as separate arrays of positions, radii and colors is the most efficient.
+    void points(std::vector<glm::vec2> const& positions, std::vector<float> const& radii, std::vector<Color> const& colors = {});
 
     /// Draws an image as big as possible on the screen. This will respect the aspect ratio of the image.
     void image(const ImageOrCanvas&, Fit = {});
@@ -268,6 +280,40 @@ public:
     /// Draws a line between two points.
     /// It uses the `stroke` color, and `stroke_weight` as its thickness.
     void line(glm::vec2 start, glm::vec2 end);
+    /// Draws a line that goes through all the points, in a single draw call.
+    /// It uses the `stroke` color, `stroke_weight` as its thickness, and `line_join` and `line_cap` to shape its corners and ends.
+    void polyline(std::vector<glm::vec2> const& points);
+    /// Draws the outline of a path.
+    /// It uses the `stroke` color, `stroke_weight` as its thickness, and `line_join` and `line_cap` to shape its corners and ends.
+    /// The triangles of the path are cached, so drawing the same path again is a single draw call, as long as neither the path nor `stroke_weight`, `line_join` and `line_cap` change.
+    void path(Path const& path);
+
+    /// Rectangles, squares, ellipses and circles are grouped together and drawn all at once, which is a lot faster than drawing them one by one.
+    /// p6 takes care of drawing them whenever needed (e.g. before switching canvas, drawing an image or using a custom shader).
+    /// You only need to call this if you mix p6 drawing functions with raw OpenGL calls: it makes sure that everything you asked p6 to draw so far has actually been drawn.
+    void flush() const;
+
+    /// The geometry of the shapes (rectangles, triangles, lines, etc.) is generated on the CPU and streamed to the GPU each frame.
+    /// Returns how much of it has been sent during the last frame, which is useful to know what is expensive in your scene.
+    StreamingStats streaming_stats() const { return _streaming_buffer.stats(); }
+
+    /// p6 remembers which OpenGL state (blending, depth test, shader in use, etc.) it has set, and only changes it when needed, instead of querying and restoring it around each draw.
+    /// If you change some of that state yourself with raw OpenGL calls and then draw with p6, call this function first so that p6 sets its state again.
+    /// :warning: p6 doesn't restore your state after drawing anymore, so set it again before your own OpenGL calls if you rely on it.
+    void opengl_state_has_changed() const;
+
+    /// Draws all the commands that have been recorded in the DrawList, on the current canvas.
+    /// Each command uses the style (fill, stroke, etc.) that was set on the DrawList when it was recorded.
+    /// The current transform is applied on top of the transforms that have been recorded.
+    void replay(const DrawList&);
+    /// Draws all the lists, by increasing key.
+    void replay(const ParallelDrawLists&);
+#ifndef P6_RAW_OPENGL_MODE
+    /// Draws all the commands that have been recorded in the DrawList, on the given canvas.
+    /// The current canvas is restored afterwards.
+    void replay(const DrawList&, Canvas&);
+    void replay(const ParallelDrawLists&, Canvas&);
+#endif
 
     /**@}*/
     /* ------------------------------- */
@@ -286,6 +332,7 @@ public:
     void text(const std::u16string& str, TopRightCorner, Rotation = {});
     void text(const std::u16string& str, BottomLeftCorner, Rotation = {});
     void text(const std::u16string& str, BottomRightCorner, Rotation = {});
+    void text(const std::u16string& str, Transform2D);
 
     /**@}*/
     /* ------------------------------- */
@@ -375,21 +422,46 @@ public:
     float canvas_ratio(const Canvas& canvas) const;
 
     /// Saves the content of the window's main canvas as an image file.
-    /// Supported file types are .png and .jpeg/.jpg
+    /// Supported file types are:
+    /// - .png and .jpeg/.jpg
+    /// - .qoi: lossless like .png, but many times faster to encode
+    /// - .ppm and .rgba: uncompressed RGB / RGBA values, nearly free to write
+    /// - .exr: half-float, which keeps the full precision of the canvas instead of truncating it to 8 bits
     /// Simply use the corresponding extension to save in the desired format.
     /// If the path already exists, a number will be appended to the name and the previous file won't be overwritten.
     /// If the path is relative, it will be relative to the directory containing your executable.
     /// If some directories in the path don't exist yet, they will be created automatically.
-    void save_image(std::filesystem::path path) const
+    /// The image is saved in the background, see `p6::save_image()`.
+    std::future<std::filesystem::path> save_image(std::filesystem::path path) const
+    {
+        return p6::save_image(_main_canvas, path);
+    }
+
+    /// Starts reading the pixels of the main canvas, without stalling the GPU. See `p6::read_pixels_async()`.
+    PixelsFuture read_pixels_async() const
     {
-        p6::save_image(_main_canvas, path);
+        return p6::read_pixels_async(_main_canvas);
     }
 #endif
 
     /// Returns the color of the pixel at the given position in the main canvas.
     /// The coordinates are expressed in the usual p6 coordinate system.
+    /// If you need many pixels, use read_pixels() instead: it is a lot faster than calling read_pixel() many times.
     Color read_pixel(glm::vec2 position) const;
 
+    /// Returns the colors of the pixels at the given positions in the main canvas, all read at once.
+    /// The coordinates are expressed in the usual p6 coordinate system.
+    std::vector<Color> read_pixels(std::vector<glm::vec2> const& positions) const;
+
+    /// Returns the pixels of the main canvas that are inside the rectangle defined by two opposite corners.
+    /// The coordinates are expressed in the usual p6 coordinate system.
+    Pixels read_region(glm::vec2 corner, glm::vec2 opposite_corner) const;
+
+    /// When enabled, the first read_pixel(), read_pixels() or read_region() copies the whole main canvas to the CPU, and the next ones read from that copy until something is drawn.
+    /// This is a lot faster if you read pixels many times between two drawings, e.g. to analyse an image you have just drawn.
+    /// :warning: p6 can't know when you draw with raw OpenGL calls, so call flush() after them to let p6 know that the copy is outdated.
+    void keep_cpu_copy_of_main_canvas(bool keep);
+
     /**@}*/
     /* ------------------------------- */
     /** \defgroup input Mouse and keyboard info
@@ -484,8 +556,41 @@ public:
     void framerate_as_high_as_possible();
 
     /// Keeps the framerate at the given value.
+    /// Between two frames p6 sleeps instead of keeping the CPU busy, so this is also a good way to save power.
     void framerate_capped_at(float framerate);
 
+    /// Only renders a new frame when something happens: an input, a resize of the window, or a call to `request_redraw()` / `request_redraw_in()`. Between two frames p6 sleeps, and uses neither the CPU nor the GPU.
+    /// This is ideal for tools and dashboards that only change when the user interacts with them.
+    /// Call one of the other framerate_...() functions to go back to rendering continuously.
+    /// :warning: time() keeps running in real time, so delta_time() can be big after a period of inactivity.
+    void render_on_demand();
+    /// In render_on_demand() mode, makes sure that a new frame is going to be rendered.
+    /// This can be called from any thread, e.g. when some data that you display has been updated in the background.
+    void request_redraw();
+    /// In render_on_demand() mode, renders a new frame after `delay` seconds. Call it from your update() to keep animating something for a while.
+    void request_redraw_in(float delay);
+
+    /// Sets the maximum time spent at the beginning of each frame uploading the images loaded with load_image_async() to the GPU.
+    /// At least one image is uploaded per frame when some are ready, even if it takes longer than the budget. The default is 2 milliseconds.
+    void images_upload_budget_per_frame(float seconds) { _images_upload_budget = seconds; }
+
+    /// Returns how regularly the frames have been starting during the last few seconds.
+    FramePacingStats frame_pacing_stats() const { return _frame_pacer.stats(); }
+
+#ifndef P6_RAW_OPENGL_MODE
+    /// Starts saving every frame of the main canvas to disk, until stop_recording() is called.
+    /// This also switches to time_perceived_as_constant_delta_time(framerate), so that the exported animation plays at the right speed no matter how long each frame takes to render.
+    /// The pixels are read back asynchronously and encoded on worker threads, so the export runs as fast as the rendering. (If the encoders can't keep up, the rendering is slowed down instead of accumulating frames in memory.)
+    /// For image sequences `path` is the folder the images will be written into, otherwise it is the path of the video file.
+    /// If the path already exists, a number will be appended to the name and the previous files won't be overwritten.
+    /// If the path is relative, it will be relative to the directory containing your executable.
+    void start_recording(std::filesystem::path const& path, float framerate, RecordingFormat format = RecordingFormat::QoiSequence);
+    /// Waits until all the recorded frames have been written to disk, and goes back to time_perceived_as_realtime().
+    void stop_recording();
+    /// Returns true iff start_recording() has been called and stop_recording() has not been called yet.
+    bool is_recording() const { return _recorder != nullptr; }
+#endif
+
     /**@}*/
     /* ------------------------------- */
     /** \defgroup update-flow Update Flow
@@ -497,6 +602,14 @@ public:
     /// update() will be called repeatedly, until you close the window or call stop().
     void start();
 
+    /// Renders a single frame: calls update() once and flushes everything that has been drawn.
+    /// This is meant for headless contexts (see `WindowCreationParams::headless`), where you want to drive the frames yourself instead of calling start(), e.g. to render a given number of frames and save them.
+    /// Use time_perceived_as_constant_delta_time() if you want the frames to be the same no matter how long they take to render.
+    void render_frame();
+
+    /// Returns true iff the context has been created with `WindowCreationParams::headless`.
+    bool is_headless() const { return _is_headless; }
+
     /// Stops the update() loop.
     /// This is the programatic equivalent of a user closing the window.
     void stop();
@@ -543,18 +656,42 @@ private:
     glm::mat3 complete_transform_matrix(const Transform2D&) const;
 
     void set_vertex_shader_uniforms(const Shader& shader, Transform2D transform) const;
-    void render_with_rect_shader(Transform2D transform, bool is_ellipse, bool is_image) const;
+    void render_with_image_shader(Transform2D transform) const;
+    void add_to_rect_batch(Transform2D transform, bool is_ellipse);
+    void add_to_triangle_batch(glm::vec2 p1, glm::vec2 p2, glm::vec2 p3, glm::mat3 const& transform);
+    /// Sends the data that all shaders can read (canvas size, time, mouse, etc.) to the GPU, if it has changed.
+    void update_frame_data() const;
+    /// Converts from p6 coordinates to pixel coordinates in the main canvas, clamped to the canvas.
+    glm::ivec2 main_canvas_pixel_coordinates(glm::vec2 position) const;
+    /// Reads a rectangle of pixels from the main canvas, with a single glReadPixels.
+    Pixels read_main_canvas_pixels(glm::ivec2 bottom_left_corner, ImageSize size) const;
+    /// The CPU copy of the main canvas, updated if necessary. See keep_cpu_copy_of_main_canvas().
+    Pixels const& main_canvas_cpu_copy() const;
+    internal::PolylineStyle polyline_style() const;
+
+    /// Does what needs to be done at the beginning of each frame, before the user starts drawing.
+    void begin_frame();
+    /// Advances the time and calls the user's update().
+    void update_once();
 
     Transform2D make_transform_2D_impl(glm::vec2 offset_to_center, glm::vec2 corner_position, Radii radii, Rotation rotation) const;
     Transform2D make_transform_2D(FullScreen) const;
 
 private:
-    std::optional<internal::ImGuiWrapper>   _imgui_wrapper{};
+    bool                                    _is_headless;
+    std::optional<internal::ImGuiWrapper>   _imgui_wrapper{}; // Empty when headless
     mutable internal::UniqueGlfwWindow      _window;
     std::unique_ptr<internal::Clock>        _clock{std::make_unique<internal::Clock_Realtime>()};
     internal::RectRenderer                  _rect_renderer;
-    internal::TriangleRenderer              _triangle_renderer;
+    mutable internal::RectBatchRenderer     _rect_batch_renderer;
+    mutable internal::TriangleBatchRenderer _triangle_batch_renderer;
+    mutable internal::OpenGLStateTracker    _opengl_state;
+    mutable internal::StreamingBuffer       _streaming_buffer;
+    mutable internal::FrameDataBuffer       _frame_data_buffer;
     internal::TextRenderer                  _text_renderer;
+    internal::PathRenderer                  _path_renderer;
+    internal::PointRenderer                 _point_renderer;
+    std::vector<glm::vec2>                  _tessellated_vertices{}; // Kept around to avoid reallocating each time we tessellate a line
     internal::TransformStack                _transform_stack{};
     ImageSize                               _framebuffer_size{1, 1};
     ImageSize                               _window_size;
@@ -563,8 +700,12 @@ private:
     glm::vec2                               _drag_start_position{};
     Button                                  _dragged_button{};
     bool                                    _is_dragging{false};
-    std::optional<std::chrono::nanoseconds> _capped_delta_time{std::nullopt};
-    std::chrono::steady_clock::time_point   _last_update{};
+    internal::FramePacer                    _frame_pacer{};
+    std::unique_ptr<internal::Recorder>     _recorder{};
+    float                                   _images_upload_budget{0.002f};
+    bool                                    _keeps_cpu_copy_of_main_canvas{false};
+    mutable Pixels                          _main_canvas_cpu_copy{};
+    mutable bool                            _main_canvas_cpu_copy_is_outdated{true};
 #ifndef P6_RAW_OPENGL_MODE
     Canvas                         _main_canvas{{1, 1}};
     CanvasSizeMode                 _main_canvas_size_mode{CanvasSizeMode_SameAsWindow{}};
@@ -575,67 +716,16 @@ private:
     int    _window_pos_y_before_fullscreen{};
     int    _window_width_before_fullscreen;
     int    _window_height_before_fullscreen;
-    Shader _rect_shader{R"(
+    Shader _image_shader{R"(
 #version 410
 
 in vec2 _raw_uv;
-in vec2 _canvas_uv;
 out vec4 _frag_color;
 
-uniform bool _is_image;
 uniform sampler2D _image;
-uniform bool _is_ellipse;
-uniform vec4 _fill_color;
-uniform vec4 _stroke_color;
-uniform float _stroke_weight;
-uniform bool _use_stroke;
-uniform vec2 _size;
-
-// Thanks to https://iquilezles.org/www/articles/ellipsedist/ellipsedist.htm
-float sdEllipse(  vec2 p,  vec2 ab ) {
-    p = abs( p );
-    bool s = dot(p/ab,p/ab)>1.0;
-    float w = s ? atan(p.y*ab.x, p.x*ab.y) : 
-                  ((ab.x*(p.x-ab.x)<ab.y*(p.y-ab.y))? 1.5707963 : 0.0);
-    // find root with Newton solver
-    for( int i=0; i<5; i++ ) {
-        vec2 cs = vec2(cos(w),sin(w));
-        vec2 u = ab*vec2( cs.x,cs.y);
-        vec2 v = ab*vec2(-cs.y,cs.x);
-        w = w + dot(p-u,v)/(dot(p-u,u)+dot(v,v));
-    }
-    return length(p-ab*vec2(cos(w),sin(w))) * (s?1.0:-1.0);
-}
 
 void main() {
-    float dist;
-    if (_is_ellipse) {
-        dist = -sdEllipse(_canvas_uv, _size);
-    }
-    else /*is_rect*/ { 
-        vec2 dd = _size - abs(_canvas_uv);
-        dist = min(dd.x, dd.y);
-    }
-
-    const float m = 0.0005;
-    if (_is_image) {
-        _frag_color = texture(_image, _raw_uv);
-    }
-    else {
-        // Fill vs Stroke
-        if (_use_stroke) {
-            float t = smoothstep(-m, m, _stroke_weight - dist);
-            _frag_color = vec4(mix(_fill_color, _stroke_color, t));
-        }
-        else {
-            _frag_color = _fill_color;
-        }
-    }
-    
-    // Shape
-    float shape_factor = _is_ellipse ? smoothstep(-m, m, dist)
-                        /*is_rect*/  : 1.;
-    _frag_color *= shape_factor;
+    _frag_color = texture(_image, _raw_uv);
 }
     )"};
     Shader _line_shader{R"(
@@ -661,6 +751,9 @@ void main()
                     : 1.;
 }
     )"};
+    // Looked up once and for all because these uniforms are set for each image / line that we draw
+    UniformHandle _image_shader_image{_image_shader.uniform("_image")};
+    UniformHandle _line_shader_material{_line_shader.uniform("_material")};
 };
 
 } // namespace p6
@@ -0,0 +1,156 @@
+#include "DrawList.h"
+#include <algorithm>
+#include <functional>
+#include "internal/TextRenderer.h"
+
+namespace p6 {
+
+void DrawList::record(internal::DrawCommandKind kind, Transform2D transform)
+{
+    _commands.push_back(internal::DrawCommand{
+        kind,
+        transform,
+        {},
+        fill,
+        stroke,
+        stroke_weight,
+        use_fill,
+        use_stroke,
+        nullptr,
+        0,
+        0,
+        text_inflating,
+    });
+}
+
+void DrawList::square(Center center, Radius radius, Rotation rotation)
+{
+    rectangle(p6::make_transform_2D(center, radius, rotation));
+}
+
+void DrawList::rectangle(Center center, Radii radii, Rotation rotation)
+{
+    rectangle(p6::make_transform_2D(center, radii, rotation));
+}
+
+void DrawList::rectangle(Transform2D transform)
+{
+    record(internal::DrawCommandKind::Rectangle, transform);
+}
+
+void DrawList::circle(Center center, Radius radius)
+{
+    ellipse(center, Radii{radius.value, radius.value});
+}
+
+void DrawList::ellipse(Center center, Radii radii, Rotation rotation)
+{
+    ellipse(p6::make_transform_2D(center, radii, rotation));
+}
+
+void DrawList::ellipse(Transform2D transform)
+{
+    record(internal::DrawCommandKind::Ellipse, transform);
+}
+
+void DrawList::triangle(Point2D p1, Point2D p2, Point2D p3, Center center, Rotation rotation)
+{
+    triangle(p1, p2, p3, Transform2D{center.value, glm::vec2{1.f}, rotation});
+}
+
+void DrawList::triangle(Point2D p1, Point2D p2, Point2D p3, Transform2D transform)
+{
+    record(internal::DrawCommandKind::Triangle, transform);
+    _commands.back().points = {p1.value, p2.value, p3.value};
+}
+
+void DrawList::line(glm::vec2 start, glm::vec2 end)
+{
+    record(internal::DrawCommandKind::Line, {});
+    _commands.back().points = {start, end, glm::vec2{0.f}};
+}
+
+void DrawList::image(const ImageOrCanvas& img, Center center, Radii radii, Rotation rotation)
+{
+    image(img, p6::make_transform_2D(center, radii, rotation));
+}
+
+void DrawList::image(const ImageOrCanvas& img, Transform2D transform)
+{
+    record(internal::DrawCommandKind::Image, transform);
+    _commands.back().image = &img;
+}
+
+void DrawList::text(const std::u16string& str, Center center, Rotation rotation)
+{
+    record(internal::DrawCommandKind::Text, p6::make_transform_2D(center, internal::TextRendererU::compute_text_radii(str, text_size), rotation));
+    _commands.back().text_offset = static_cast<uint32_t>(_texts.size());
+    _commands.back().text_length = static_cast<uint32_t>(str.size());
+    _texts += str;
+}
+
+std::u16string DrawList::text_of(const internal::DrawCommand& command) const
+{
+    return _texts.substr(command.text_offset, command.text_length);
+}
+
+static auto pipeline_state_order(internal::DrawCommandKind kind) -> int
+{
+    switch (kind)
+    {
+    case internal::DrawCommandKind::Rectangle:
+    case internal::DrawCommandKind::Ellipse: // Rectangles and ellipses are batched together
+        return 0;
+    case internal::DrawCommandKind::Triangle:
+        return 1;
+    case internal::DrawCommandKind::Line:
+        return 2;
+    case internal::DrawCommandKind::Text:
+        return 3;
+    case internal::DrawCommandKind::Image:
+        return 4;
+    default:
+        return 5;
+    }
+}
+
+void DrawList::sort_by_pipeline_state()
+{
+    std::stable_sort(_commands.begin(), _commands.end(), [](internal::DrawCommand const& a, internal::DrawCommand const& b) {
+        const auto order_a = pipeline_state_order(a.kind);
+        const auto order_b = pipeline_state_order(b.kind);
+        if (order_a != order_b)
+            return order_a < order_b;
+        return std::less<const ImageOrCanvas*>{}(a.image, b.image); // Group the images that use the same texture
+    });
+}
+
+void DrawList::clear()
+{
+    _commands.clear();
+    _texts.clear();
+}
+
+DrawList& ParallelDrawLists::operator[](uint64_t key)
+{
+    std::lock_guard lock{_mutex};
+    return _lists[key];
+}
+
+void ParallelDrawLists::clear()
+{
+    std::lock_guard lock{_mutex};
+    for (auto& [key, list] : _lists)
+        list.clear();
+}
+
+size_t ParallelDrawLists::size() const
+{
+    std::lock_guard lock{_mutex};
+    size_t          total{0};
+    for (auto const& [key, list] : _lists)
+        total += list.size();
+    return total;
+}
+
+} // namespace p6
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Color.h"
+#include "ImageCommon.h"
+#include "Transform2D.h"
+
+namespace p6 {
+
+namespace internal {
+
+enum class DrawCommandKind : uint8_t {
+    Rectangle,
+    Ellipse,
+    Triangle,
+    Line,
+    Image,
+    Text,
+};
+
+/// A drawing call, together with the style that was active when it was recorded.
+struct DrawCommand {
+    DrawCommandKind          kind;
+    Transform2D              transform;
+    std::array<glm::vec2, 3> points;
+    Color                    fill;
+    Color                    stroke;
+    float                    stroke_weight;
+    bool                     use_fill;
+    bool                     use_stroke;
+    const ImageOrCanvas*     image;
+    uint32_t                 text_offset;
+    uint32_t                 text_length;
+    float                    text_inflating;
+};
+
+} // namespace internal
+
+/* ------------------------------- */
+/** \defgroup draw-list Draw List
+ * Record drawing commands once and replay them as many times as you want, on any canvas.
+ * @{*/
+/* ------------------------------- */
+
+/// Records drawing commands instead of executing them.
+/// Use `Context::replay()` to actually draw them, as many times as you want and on any canvas.
+/// A DrawList doesn't touch the GPU while recording, so you can fill it from any thread (as long as each DrawList is only used by one thread at a time).
+///
+/// ```
+/// auto list = p6::DrawList{};
+/// list.fill = p6::NamedColor::Red;
+/// list.circle(p6::Center{}, p6::Radius{0.3f});
+/// ctx.replay(list);
+/// ```
+class DrawList {
+public:
+    /// The color that is used for the interior of the shapes.
+    Color fill{1.f, 1.f, 1.f, 0.5f};
+    /// Whether the shapes will have an interior
+    bool use_fill = true;
+    /// The color that is used for the boundary of the shapes.
+    Color stroke{0.f, 0.f, 0.f};
+    /// The size of the boundary of the shapes.
+    float stroke_weight = 0.01f;
+    /// Whether there will be a boundary on the shape.
+    bool use_stroke = true;
+    /// Height of the text.
+    float text_size = 0.03f;
+    /// Gives some "boldness" to the text.
+    float text_inflating = 0.01f;
+
+    /// Records a square
+    void square(Center = {}, Radius = {}, Rotation = {});
+    /// Records a rectangle
+    void rectangle(Center, Radii = {}, Rotation = {});
+    void rectangle(Transform2D);
+    /// Records a circle
+    void circle(Center = {}, Radius = {});
+    /// Records an ellipse
+    void ellipse(Center, Radii = {}, Rotation = {});
+    void ellipse(Transform2D);
+    /// Records a triangle between the three points, translated by `Center` and rotated by `Rotation`.
+    void triangle(Point2D, Point2D, Point2D, Center = {}, Rotation = {});
+    /// Records a triangle between the three points, and applies the transform to the triangle.
+    void triangle(Point2D, Point2D, Point2D, Transform2D);
+    /// Records a line between two points.
+    /// It uses the `stroke` color, and `stroke_weight` as its thickness.
+    void line(glm::vec2 start, glm::vec2 end);
+    /// Records an image. :warning: The DrawList only stores a reference to the image, so it must still be alive when you replay the list.
+    void image(const ImageOrCanvas&, Center, Radii = {}, Rotation = {});
+    void image(const ImageOrCanvas&, Transform2D);
+    /// Records some text
+    void text(const std::u16string& str, Center, Rotation = {});
+
+    /// Reorders the commands so that the ones that use the same kind of rendering are next to each other, which allows p6 to draw them with fewer state changes.
+    /// The relative order of commands of the same kind is preserved.
+    /// :warning: This changes the order in which shapes of different kinds are drawn, so only use it if those shapes don't overlap, or if you don't care about which one ends up on top.
+    void sort_by_pipeline_state();
+
+    /// Removes all the recorded commands. The memory is kept so that recording the next frame doesn't need to allocate.
+    void clear();
+    /// Returns the number of recorded commands.
+    size_t size() const { return _commands.size(); }
+    /// Returns true iff no command has been recorded.
+    bool empty() const { return _commands.empty(); }
+
+    /// For advanced uses only.
+    const std::vector<internal::DrawCommand>& commands() const { return _commands; }
+    /// For advanced uses only.
+    /// Returns the text that is drawn by a command of kind `Text`.
+    std::u16string text_of(const internal::DrawCommand& command) const;
+
+private:
+    void record(internal::DrawCommandKind kind, Transform2D transform);
+
+private:
+    std::vector<internal::DrawCommand> _commands{};
+    std::u16string                     _texts{};
+};
+
+/// Lets several threads record drawing commands at the same time, each one into its own DrawList.
+/// Each list is identified by a key, and `Context::replay()` draws the lists by increasing key, so the result doesn't depend on which thread finished first.
+///
+/// ```
+/// auto lists = p6::ParallelDrawLists{};
+/// std::for_each(std::execution::par, chunks.begin(), chunks.end(), [&](Chunk const& chunk) {
+///     auto& list = lists[chunk.index]; // Use the index of the chunk as the key, so that chunks are always drawn in the same order
+///     for (auto const& particle : chunk.particles)
+///         list.circle(p6::Center{particle.position}, p6::Radius{0.01f});
+/// });
+/// ctx.replay(lists);
+/// ```
+class ParallelDrawLists {
+public:
+    /// Returns the list that has this key, and creates it if it doesn't exist yet.
+    /// This can be called from any thread, but a given list must only be filled by one thread at a time.
+    DrawList& operator[](uint64_t key);
+
+    /// Clears all the lists. Their memory is kept so that recording the next frame doesn't need to allocate.
+    /// :warning: This must not be called while other threads are recording.
+    void clear();
+    /// Returns the total number of recorded commands, across all the lists.
+    size_t size() const;
+
+    /// For advanced uses only.
+    /// The lists, sorted by key.
+    const std::map<uint64_t, DrawList>& lists() const { return _lists; }
+
+private:
+    std::map<uint64_t, DrawList> _lists{}; // A std::map keeps the lists sorted by key, and never moves them, so that a thread can keep using its list while other threads create theirs
+    mutable std::mutex           _mutex{};
+};
+
+/**@}*/
+
+} // namespace p6
@@ -1,6 +1,12 @@
 #include "Image.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
 #include <img/img.hpp>
+#include <iostream>
+#include <optional>
 #include <stdexcept>
+#include "internal/ImageLoader.h"
 #include "make_absolute_path.h"
 
 namespace p6 {
@@ -10,6 +16,121 @@ Image::Image(ImageSize size, const uint8_t* data, glpp::TextureLayout texture_la
     _texture.upload_data(size, data, texture_layout);
 }
 
+StreamingImage::StreamingImage(ImageSize size, glpp::InternalFormat internal_format)
+    : _size{size}
+{
+    _texture.upload_data(size, nullptr, {internal_format, glpp::Channels::RGBA, glpp::TexelDataType::UnsignedByte});
+    const auto size_in_bytes = 4 * static_cast<GLsizeiptr>(size.width()) * static_cast<GLsizeiptr>(size.height());
+    for (auto const& buffer : _pixel_buffers)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.id());
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, size_in_bytes, nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+StreamingImage::~StreamingImage()
+{
+    for (auto const& fence : _fences)
+    {
+        if (fence)
+            glDeleteSync(fence);
+    }
+}
+
+/// Returns the part of the region that is inside the image, or nothing if it is empty.
+static auto clamped_to_image(PixelRegion const& region, ImageSize image_size) -> std::optional<PixelRegion>
+{
+    const auto image_corner = glm::ivec2{image_size.width(), image_size.height()};
+    const auto bottom_left  = glm::clamp(region.bottom_left_corner, glm::ivec2{0}, image_corner);
+    const auto top_right    = glm::clamp(region.bottom_left_corner + glm::ivec2{region.size.width(), region.size.height()}, glm::ivec2{0}, image_corner);
+    if (top_right.x <= bottom_left.x || top_right.y <= bottom_left.y)
+        return std::nullopt;
+    return PixelRegion{bottom_left, {top_right.x - bottom_left.x, top_right.y - bottom_left.y}};
+}
+
+void StreamingImage::update(const uint8_t* data, const std::vector<PixelRegion>& dirty_regions)
+{
+    auto regions = std::vector<PixelRegion>{};
+    if (dirty_regions.empty())
+    {
+        regions.push_back({{0, 0}, _size});
+    }
+    else
+    {
+        regions.reserve(dirty_regions.size());
+        for (auto const& region : dirty_regions)
+        {
+            if (const auto clamped = clamped_to_image(region, _size))
+                regions.push_back(*clamped);
+        }
+        if (regions.empty())
+            return;
+    }
+    const auto width = static_cast<size_t>(_size.width());
+
+    // The buffer was last used buffers_count updates ago, so in practice the GPU is almost always done with it and this doesn't block
+    auto& fence = _fences[_next_buffer];
+    if (fence)
+    {
+        while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000'000) == GL_TIMEOUT_EXPIRED) {}
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    // Sends the regions to the texture, reading them either from the bound pixel buffer or directly from `data`
+    const auto upload_regions = [&](bool from_pixel_buffer) {
+        _texture.bind_to_texture_unit(0);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, _size.width());
+        for (auto const& region : regions)
+        {
+            const auto offset = 4 * (static_cast<size_t>(region.bottom_left_corner.y) * width + static_cast<size_t>(region.bottom_left_corner.x));
+            glTexSubImage2D(GL_TEXTURE_2D, 0,
+                            region.bottom_left_corner.x, region.bottom_left_corner.y,
+                            region.size.width(), region.size.height(),
+                            GL_RGBA, GL_UNSIGNED_BYTE,
+                            from_pixel_buffer ? reinterpret_cast<const void*>(offset) // NOLINT(*-reinterpret-cast, performance-no-int-to-ptr)
+                                              : data + offset);                       // NOLINT(*-pointer-arithmetic)
+        }
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    };
+
+    // Copy the dirty regions into the buffer, at the same place as in the image so that the texture uploads can read them directly
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _pixel_buffers[_next_buffer].id());
+    const auto size_in_bytes = 4 * width * static_cast<size_t>(_size.height());
+    auto*      memory        = static_cast<uint8_t*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(size_in_bytes), GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT)); // We have waited for the fence, so there is no need for the driver to synchronize
+    if (!memory)
+    {
+        // Should never happen, but if it does the buffer doesn't contain our pixels, so we send them directly (which is slower because it blocks until the driver has copied them)
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        std::cerr << "[p6::StreamingImage::update] Failed to map the pixel buffer, uploading the pixels without it.\n";
+        upload_regions(false);
+        return;
+    }
+    for (auto const& region : regions)
+    {
+        const auto row_size = 4 * static_cast<size_t>(region.size.width());
+        for (GLsizei y = 0; y < region.size.height(); ++y)
+        {
+            const auto offset = 4 * (static_cast<size_t>(region.bottom_left_corner.y + y) * width + static_cast<size_t>(region.bottom_left_corner.x));
+            std::memcpy(memory + offset, data + offset, row_size); // NOLINT(*-pointer-arithmetic)
+        }
+    }
+    if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_FALSE) // The content of the buffer has been lost (e.g. because of a screen mode change)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        upload_regions(false);
+        return;
+    }
+
+    // Upload from the buffer. This only queues a copy on the GPU and returns immediately.
+    upload_regions(true);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0); // Otherwise the other texture uploads would read from our buffer
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    _next_buffer = (_next_buffer + 1) % buffers_count;
+}
+
 Image load_image(std::filesystem::path file_path, bool flip_vertically)
 {
     try
@@ -39,4 +160,80 @@ img::Image load_image_buffer(std::filesystem::path file_path, bool flip_vertical
     }
 }
 
+AsyncImage::AsyncImage(std::shared_ptr<internal::AsyncImageState> state)
+    : _state{std::move(state)}
+{}
+
+bool AsyncImage::is_ready() const
+{
+    return _state->is_ready;
+}
+
+bool AsyncImage::has_failed() const
+{
+    return !_state->error_message.empty();
+}
+
+const std::string& AsyncImage::error_message() const
+{
+    return _state->error_message;
+}
+
+const std::filesystem::path& AsyncImage::path() const
+{
+    return _state->path;
+}
+
+ImageSize AsyncImage::size() const
+{
+    return _state->size;
+}
+
+const glpp::Texture2D& AsyncImage::texture() const
+{
+    return _state->texture;
+}
+
+AsyncImage load_image_async(std::filesystem::path file_path, bool flip_vertically)
+{
+    return AsyncImage{internal::ImageLoader::instance().load(file_path, flip_vertically)};
+}
+
+static auto is_image_file(const std::filesystem::directory_entry& entry) -> bool
+{
+    if (!entry.is_regular_file())
+        return false;
+    auto extension = entry.path().extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == ".png"
+           || extension == ".jpg"
+           || extension == ".jpeg"
+           || extension == ".bmp"
+           || extension == ".tga"
+           || extension == ".gif"
+           || extension == ".psd"
+           || extension == ".hdr"
+           || extension == ".pic"
+           || extension == ".pnm"
+           || extension == ".pgm"
+           || extension == ".ppm";
+}
+
+std::vector<AsyncImage> load_images_async_from_directory(std::filesystem::path directory_path, bool flip_vertically)
+{
+    auto paths = std::vector<std::filesystem::path>{};
+    for (const auto& entry : std::filesystem::directory_iterator{make_absolute_path(directory_path)})
+    {
+        if (is_image_file(entry))
+            paths.push_back(entry.path());
+    }
+    std::sort(paths.begin(), paths.end());
+
+    auto images = std::vector<AsyncImage>{};
+    images.reserve(paths.size());
+    for (const auto& path : paths)
+        images.push_back(load_image_async(path, flip_vertically));
+    return images;
+}
+
 } // namespace p6
\ No newline at end of file
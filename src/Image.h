@@ -1,12 +1,21 @@
 #pragma once
 
+#include <array>
 #include <filesystem>
+#include <glm/glm.hpp>
 #include <glpp/extended.hpp>
+#include <memory>
+#include <string>
+#include <vector>
 #include "ImageCommon.h"
 #include "img/img.hpp"
 
 namespace p6 {
 
+namespace internal {
+struct AsyncImageState;
+}
+
 /* ------------------------------- */
 /** \defgroup image Image
  * Load and query information about images.
@@ -35,6 +44,50 @@ private:
     glpp::Texture2D _texture;
 };
 
+/// A rectangle of pixels inside an image.
+struct PixelRegion {
+    glm::ivec2 bottom_left_corner;
+    ImageSize  size;
+};
+
+/// An image whose pixels you can replace every frame, e.g. to display the frames of a webcam or some procedurally generated pixels.
+/// The pixels are sent to the GPU through a ring of three pixel buffer objects, so update() doesn't wait for the GPU to be done with the previous frames, and the upload can happen in parallel with the rendering.
+class StreamingImage : public ImageOrCanvas {
+public:
+    /// Creates an image with undefined content. Call update() to fill it.
+    /// internal_format is an advanced setting; it controls how the pixels are gonna be stored on the GPU. The pixels you give to update() are always RGBA 8-bit.
+    explicit StreamingImage(ImageSize size, glpp::InternalFormat internal_format = glpp::InternalFormat::RGBA8);
+    ~StreamingImage();
+    StreamingImage(const StreamingImage&)            = delete;
+    StreamingImage& operator=(const StreamingImage&) = delete;
+    StreamingImage(StreamingImage&&)                 = delete;
+    StreamingImage& operator=(StreamingImage&&)      = delete;
+
+    /// Replaces the pixels of the image.
+    /// data must be an array of size `size().width() * size().height() * 4`, with R, G, B and A channels, starting with the bottom left pixel, and going row by row.
+    /// If you know which parts of the image have changed, pass them as `dirty_regions`: only those will be copied and uploaded. If it is empty, the whole image is uploaded.
+    /// The parts of the regions that are outside of the image are ignored.
+    void update(const uint8_t* data, const std::vector<PixelRegion>& dirty_regions = {});
+
+    /// Returns the size in pixels.
+    ImageSize size() const { return _size; }
+    /// Returns the aspect ratio (`width / height`)
+    float aspect_ratio() const override { return _size.aspect_ratio(); }
+    /// Returns the inverse aspect ratio (`height / width`)
+    float inverse_aspect_ratio() const { return _size.inverse_aspect_ratio(); }
+
+    const glpp::Texture2D& texture() const override { return _texture; }
+
+private:
+    static constexpr size_t buffers_count = 3;
+
+    ImageSize                                     _size;
+    glpp::Texture2D                               _texture;
+    std::array<glpp::UniqueBuffer, buffers_count> _pixel_buffers{};
+    std::array<GLsync, buffers_count>             _fences{}; // Tell us when the GPU is done reading from each buffer
+    size_t                                        _next_buffer{0};
+};
+
 /// Loads an image from a file.
 /// If the path is relative, it will be relative to the directory containing your executable.
 /// Throws a `std::runtime_error` if the file doesn't exist or isn't a valid image file.
@@ -48,6 +101,46 @@ private:
 /// Set `flip_vertically` to false if your image appears upside-down.
 [[nodiscard]] img::Image load_image_buffer(std::filesystem::path file_path, bool flip_vertically = true);
 
+/// An image that is being loaded in the background by load_image_async().
+/// You can draw it right away: until it is ready it shows a grey placeholder.
+class AsyncImage : public ImageOrCanvas {
+public:
+    /// Returns true iff the image has been loaded and uploaded to the GPU.
+    bool is_ready() const;
+    /// Returns true iff the image couldn't be loaded. error_message() tells you why.
+    bool has_failed() const;
+    /// Returns why the image couldn't be loaded, or an empty string if it hasn't failed.
+    const std::string& error_message() const;
+    /// Returns the path the image is loaded from.
+    const std::filesystem::path& path() const;
+
+    /// Returns the size in pixels, or 1x1 while the image isn't ready.
+    ImageSize size() const;
+    /// Returns the aspect ratio (`width / height`), or 1 while the image isn't ready.
+    float aspect_ratio() const override { return size().aspect_ratio(); }
+
+    const glpp::Texture2D& texture() const override;
+
+private:
+    friend AsyncImage load_image_async(std::filesystem::path file_path, bool flip_vertically);
+    explicit AsyncImage(std::shared_ptr<internal::AsyncImageState> state);
+
+private:
+    std::shared_ptr<internal::AsyncImageState> _state;
+};
+
+/// Loads an image from a file without blocking: the file is read and decoded on worker threads, and the image is uploaded to the GPU at the beginning of one of the next frames.
+/// A few images are uploaded each frame, within the budget set by `Context::images_upload_budget_per_frame()`, so that loading many images never makes a frame hitch.
+/// If the path is relative, it will be relative to the directory containing your executable.
+/// If the file doesn't exist or isn't a valid image file, the returned image reports it with has_failed() instead of throwing.
+/// Set `flip_vertically` to false if your image appears upside-down.
+[[nodiscard]] AsyncImage load_image_async(std::filesystem::path file_path, bool flip_vertically = true);
+
+/// Loads all the images of a directory in the background, sorted by file name. See load_image_async().
+/// If the path is relative, it will be relative to the directory containing your executable.
+/// Throws a `std::runtime_error` if the directory doesn't exist.
+[[nodiscard]] std::vector<AsyncImage> load_images_async_from_directory(std::filesystem::path directory_path, bool flip_vertically = true);
+
 /**@}*/
 
 } // namespace p6
\ No newline at end of file
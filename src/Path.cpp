@@ -0,0 +1,95 @@
+#include "Path.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace p6 {
+
+// Maximum length of the straight segments that approximate a curve.
+static constexpr float curve_flattening_precision = 0.01f;
+
+static auto curve_segments_count(float control_polygon_length) -> int
+{
+    return std::clamp(static_cast<int>(std::ceil(control_polygon_length / curve_flattening_precision)), 1, 256);
+}
+
+void Path::has_changed()
+{
+    // Unique across all the paths, so that the Context can use it to know which triangles belong to which path
+    static auto next_version = std::atomic<uint64_t>{1};
+    _version                 = next_version.fetch_add(1, std::memory_order_relaxed);
+}
+
+internal::PathContour& Path::current_contour()
+{
+    if (_contours.empty())
+        _contours.emplace_back().points.emplace_back(0.f);
+    return _contours.back();
+}
+
+void Path::move_to(glm::vec2 point)
+{
+    has_changed();
+    if (!_contours.empty() && _contours.back().points.size() <= 1) // Reuse the previous contour if nothing has been drawn in it
+        _contours.back() = {};
+    else
+        _contours.emplace_back();
+    _contours.back().points.push_back(point);
+}
+
+void Path::line_to(glm::vec2 point)
+{
+    has_changed();
+    if (_contours.empty())
+    {
+        move_to(point);
+        return;
+    }
+    current_contour().points.push_back(point);
+}
+
+void Path::quadratic_bezier_to(glm::vec2 control, glm::vec2 end)
+{
+    has_changed();
+    auto&      points = current_contour().points;
+    const auto start  = points.back();
+    const auto count  = curve_segments_count(glm::distance(start, control) + glm::distance(control, end));
+    for (int i = 1; i <= count; ++i)
+    {
+        const float t = static_cast<float>(i) / static_cast<float>(count);
+        const float u = 1.f - t;
+        points.push_back(u * u * start + 2.f * u * t * control + t * t * end);
+    }
+}
+
+void Path::bezier_to(glm::vec2 control1, glm::vec2 control2, glm::vec2 end)
+{
+    has_changed();
+    auto&      points = current_contour().points;
+    const auto start  = points.back();
+    const auto count  = curve_segments_count(glm::distance(start, control1) + glm::distance(control1, control2) + glm::distance(control2, end));
+    for (int i = 1; i <= count; ++i)
+    {
+        const float t = static_cast<float>(i) / static_cast<float>(count);
+        const float u = 1.f - t;
+        points.push_back(u * u * u * start + 3.f * u * u * t * control1 + 3.f * u * t * t * control2 + t * t * t * end);
+    }
+}
+
+void Path::close()
+{
+    has_changed();
+    auto& contour     = current_contour();
+    contour.is_closed = true;
+    // Following commands start a new contour at the same point, like in most vector graphics APIs
+    const auto start = contour.points.front();
+    _contours.emplace_back().points.push_back(start);
+}
+
+void Path::clear()
+{
+    has_changed();
+    _contours.clear();
+}
+
+} // namespace p6
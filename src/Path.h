@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace p6 {
+
+namespace internal {
+
+/// A connected piece of a path, already flattened into straight segments.
+struct PathContour {
+    std::vector<glm::vec2> points;
+    bool                   is_closed{false};
+};
+
+} // namespace internal
+
+/// How two consecutive segments of a line are connected.
+enum class LineJoin : uint8_t {
+    Round,
+    Miter,
+    Bevel,
+};
+
+/// How the two ends of a line look like.
+enum class LineCap : uint8_t {
+    Round,
+    Square,
+    Butt,
+};
+
+/// \ingroup drawing
+/// A shape made of lines and curves, that you can draw with `Context::path()`.
+/// The path is turned into triangles the first time it is drawn, and the Context keeps them on the GPU until the path (or the stroke style) changes, so drawing the same path every frame is very cheap.
+/// A Path doesn't own any OpenGL object, so you can build paths on any thread, and keep them after the Context has been destroyed.
+///
+/// ```
+/// auto path = p6::Path{};
+/// path.move_to({-0.5f, 0.f});
+/// path.bezier_to({-0.5f, 0.5f}, {0.5f, 0.5f}, {0.5f, 0.f});
+/// ctx.path(path);
+/// ```
+class Path {
+public:
+    /// Starts a new contour at the given point.
+    void move_to(glm::vec2 point);
+    /// Adds a straight line from the current point to `point`.
+    void line_to(glm::vec2 point);
+    /// Adds a quadratic Bézier curve from the current point to `end`.
+    void quadratic_bezier_to(glm::vec2 control, glm::vec2 end);
+    /// Adds a cubic Bézier curve from the current point to `end`.
+    void bezier_to(glm::vec2 control1, glm::vec2 control2, glm::vec2 end);
+    /// Connects the current point to the start of the current contour.
+    void close();
+
+    /// Removes everything from the path.
+    void clear();
+    /// Returns true iff nothing has been added to the path.
+    bool empty() const { return _contours.empty(); }
+
+    /// For advanced uses only.
+    const std::vector<internal::PathContour>& contours() const { return _contours; }
+    /// For advanced uses only.
+    /// Changes each time the path is modified. Two paths with the same version have the same contours (e.g. because one is a copy of the other).
+    uint64_t version() const { return _version; }
+
+private:
+    internal::PathContour& current_contour();
+    void                   has_changed();
+
+private:
+    std::vector<internal::PathContour> _contours{};
+    uint64_t                           _version{0};
+};
+
+} // namespace p6
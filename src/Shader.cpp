@@ -1,19 +1,28 @@
 #include "Shader.h"
+#include <algorithm>
+#include <cstring>
 #include <fstream>
+#include <future>
+#include <glm/gtc/type_ptr.hpp>
 #include <iostream>
 #include <iterator>
+#include <limits>
 #include <stdexcept>
 #include <string_view>
+#include "internal/FrameData.h"
+#include "internal/ThreadPool.h"
+#include "internal/parallel_shader_compile.h"
+#include "internal/program_binary_cache.h"
 #include "internal/string_utils.h"
 #include "make_absolute_path.h"
 
 namespace p6 {
 
-GLenum Shader::s_available_texture_slot{0};
+GLenum              Shader::s_available_texture_slot{0};
+UniformUploadsStats Shader::s_uniform_uploads_stats{};
+static GLuint s_currently_used_program{0};
 
-Shader::Shader(std::string_view fragment_source_code)
-    : Shader{ShaderSources{
-        /*. vertex = */ R"(
+static constexpr const char* default_vertex_shader = R"(
 #version 410
 
 layout(location = 0) in vec2 _vertex_position;
@@ -23,7 +32,6 @@ out vec2 _uniform_uv;
 out vec2 _canvas_uv;
 
 uniform mat3 _transform;
-uniform float _window_inverse_aspect_ratio;
 uniform vec2 _size;
 uniform float _aspect_ratio;
 
@@ -32,13 +40,17 @@ void main()
     vec2 pos = _vertex_position;
     vec3 pos3 = _transform * vec3(pos, 1.);
     pos = pos3.xy / pos3.z;
-    pos.x *= _window_inverse_aspect_ratio;
+    pos.x *= _canvas_inverse_aspect_ratio;
     gl_Position = vec4(pos, 0., 1.);
     _raw_uv = _texture_coordinates;
     _uniform_uv = (_texture_coordinates - 0.5) * vec2(_aspect_ratio, 1.) * 2.;
     _canvas_uv = (_texture_coordinates - 0.5) * _size * 2.;
 }
-    )",
+    )";
+
+Shader::Shader(std::string_view fragment_source_code)
+    : Shader{ShaderSources{
+        /* .vertex   = */ default_vertex_shader,
         /* .fragment = */ std::string{fragment_source_code},
     }}
 {}
@@ -50,7 +62,6 @@ Shader::Shader(std::string_view vertex_source_code, std::string_view fragment_so
     }}
 {}
 
-#if !defined(NDEBUG)
 static auto find_exact_word(std::string_view text, std::string_view keyword, size_t start = 0) -> size_t
 {
     auto const is_delimiter = [](char c) {
@@ -67,11 +78,14 @@ static auto find_exact_word(std::string_view text, std::string_view keyword, siz
     return offset;
 }
 
-static void append_uniforms_names(std::string source_code, std::unordered_map<std::string, bool>& has_uniform_been_set)
+#if !defined(NDEBUG)
+/// Returns the names of all the uniforms declared in the source code, except the ones inside uniform blocks (they can't be set individually).
+static auto uniforms_names(std::string source_code) -> std::vector<std::string>
 {
     source_code        = internal::remove_comments(source_code);
     auto const keyword = std::string_view{"uniform"};
 
+    auto   names  = std::vector<std::string>{};
     size_t offset = find_exact_word(source_code, keyword);
     while (offset != std::string::npos)
     {
@@ -80,103 +94,342 @@ static void append_uniforms_names(std::string source_code, std::unordered_map<st
         auto const type_pos = internal::find_next_word_position(source_code, offset);
         if (!type_pos)
             break;
+        auto const after_type = source_code.find_first_not_of(" \n\t\r", type_pos->second);
+        if (after_type != std::string::npos && source_code[after_type] == '{') // This is a uniform block, e.g. `uniform Block { float x; };`
+        {
+            offset = find_exact_word(source_code, keyword, source_code.find('}', after_type));
+            continue;
+        }
         auto const name = internal::next_word(source_code, type_pos->second);
         if (!name)
             break;
 
-        has_uniform_been_set[std::string{*name}] = false;
+        names.emplace_back(*name);
 
         offset = find_exact_word(source_code, keyword, type_pos->second);
     }
+    return names;
 }
-#endif
 
-template<glpp::ShaderType Type>
-static auto gen_shader_module(std::optional<std::string> const& source_code
-#if !defined(NDEBUG)
-                              ,
-                              std::string const&                     stage_name,
-                              std::unordered_map<std::string, bool>& has_uniform_been_set
+static void append_uniforms_names(std::string const& source_code, std::vector<internal::UniformInfo>& uniforms)
+{
+    for (auto& name : uniforms_names(source_code))
+    {
+        if (std::none_of(uniforms.begin(), uniforms.end(), [&](internal::UniformInfo const& uniform) { return uniform.name == name; })) // The same uniform can be declared in several stages
+            uniforms.push_back({std::move(name), -1});
+    }
+}
 #endif
-                              ) -> std::optional<glpp::internal::Shader<Type>>
+
+/// Inserts some code at the beginning of the shader. It must come after the #version directive.
+static auto insert_after_version_directive(std::string const& source_code, std::string_view code_to_insert) -> std::string
+{
+    auto       insert_pos  = size_t{0};
+    auto const version_pos = source_code.find("#version");
+    if (version_pos != std::string::npos)
+    {
+        auto const end_of_line = source_code.find('\n', version_pos);
+        insert_pos             = end_of_line == std::string::npos ? source_code.size() : end_of_line + 1;
+    }
+    // Make sure the line numbers reported in compilation errors still match the user's source code
+    auto const next_line_number = std::count(source_code.begin(), source_code.begin() + static_cast<std::ptrdiff_t>(insert_pos), '\n') + 1;
+    return source_code.substr(0, insert_pos)
+           + std::string{code_to_insert}
+           + "#line " + std::to_string(next_line_number) + '\n'
+           + source_code.substr(insert_pos);
+}
+
+/// Returns true iff `name` appears at global scope, i.e. outside of any function body or parameter list.
+/// In GLSL, global initializers must be constant expressions, so a name that appears there is being declared (e.g. `uniform float _time;`, `in vec2 _mouse;`, `const float _time = 1.;`, or a `#define`).
+static auto is_declared_at_global_scope(std::string_view code, std::string_view name) -> bool
+{
+    for (auto offset = find_exact_word(code, name); offset != std::string_view::npos; offset = find_exact_word(code, name, offset + name.size()))
+    {
+        auto const before = code.substr(0, offset);
+        auto const depth  = std::count(before.begin(), before.end(), '{') - std::count(before.begin(), before.end(), '}')
+                           + std::count(before.begin(), before.end(), '(') - std::count(before.begin(), before.end(), ')');
+        if (depth == 0)
+            return true;
+    }
+    return false;
+}
+
+/// Declares the uniform block that contains the data that p6 shares with all shaders (`_time`, `_mouse`, etc.), if the shader uses it.
+/// The names that the shader declares itself (as uniforms, inputs, constants, etc.) are left alone, so that older shaders that set e.g. their own `_time` uniform keep working.
+/// The members of the block have reserved names, so this works even when another stage of the same program uses the block.
+static auto with_frame_data_declaration_if_needed(std::optional<std::string> const& source_code) -> std::optional<std::string>
 {
     if (!source_code)
         return std::nullopt;
-    auto module = glpp::internal::Shader<Type>{source_code->data()};
+
+    auto const code = internal::remove_comments(*source_code);
+    auto const uses = [&](std::string_view name) {
+        return find_exact_word(code, name) != std::string::npos;
+    };
+    if (std::none_of(std::begin(internal::frame_data_members_names), std::end(internal::frame_data_members_names), uses)
+        || uses(internal::frame_data_block_name))
+    {
+        return source_code;
+    }
+    auto declarations = std::string{internal::frame_data_glsl_declaration};
+    for (auto const name : internal::frame_data_members_names)
+    {
+        if (uses(name) && !is_declared_at_global_scope(code, name))
+            declarations += "#define " + std::string{name} + " _p6" + std::string{name} + '\n';
+    }
+    return insert_after_version_directive(*source_code, declarations);
+}
+
+/// Adds a `#define` for each of the defines, if there is a source code.
+static auto with_defines(std::optional<std::string> const& source_code, std::vector<std::string> const& defines) -> std::optional<std::string>
+{
+    if (!source_code || defines.empty())
+        return source_code;
+    auto declarations = std::string{};
+    for (auto const& define : defines)
+        declarations += "#define " + define + '\n';
+    return insert_after_version_directive(*source_code, declarations);
+}
+
+namespace internal {
+
+auto prepare_shader_sources(ShaderSources const& sources) -> PreparedShaderSources
+{
+    auto prepared = PreparedShaderSources{
+        ShaderSources{
+            with_frame_data_declaration_if_needed(sources.vertex),
+            with_frame_data_declaration_if_needed(sources.fragment),
+            with_frame_data_declaration_if_needed(sources.geometry),
+            with_frame_data_declaration_if_needed(sources.tessellation_control),
+            with_frame_data_declaration_if_needed(sources.tessellation_evaluation),
+        },
+        {},
+    };
 #if !defined(NDEBUG)
+    for (auto const* source_code : {&prepared.sources.vertex, &prepared.sources.fragment, &prepared.sources.geometry, &prepared.sources.tessellation_control, &prepared.sources.tessellation_evaluation})
     {
-        append_uniforms_names(*source_code, has_uniform_been_set);
-        auto const err = module.check_compilation_errors();
-        if (err)
-        {
-            auto const msg = stage_name + " shader compilation failed:\n" + err.message();
-            std::cerr << msg << '\n';
-            throw std::runtime_error{msg};
-        }
+        if (*source_code)
+            append_uniforms_names(**source_code, prepared.uniforms);
     }
 #endif
-    return module;
+    return prepared;
 }
 
-Shader::Shader(ShaderSources const& sources)
+} // namespace internal
+
+template<glpp::ShaderType Type>
+static void start_compiling(std::optional<glpp::internal::Shader<Type>>& module, std::optional<std::string> const& source_code, glpp::ext::Program& program)
 {
-    auto const vert = gen_shader_module<glpp::ShaderType::Vertex>(sources.vertex
+    if (!source_code)
+        return;
+    module.emplace(source_code->data());
+    program.attach_shader(module->id());
+}
+
 #if !defined(NDEBUG)
-                                                                  ,
-                                                                  "Vertex",
-                                                                  _has_uniform_been_set
+template<glpp::ShaderType Type>
+static void throw_if_compilation_failed(std::optional<glpp::internal::Shader<Type>> const& module, std::string const& stage_name)
+{
+    if (!module)
+        return;
+    auto const err = module->check_compilation_errors();
+    if (err)
+    {
+        auto const msg = stage_name + " shader compilation failed:\n" + err.message();
+        std::cerr << msg << '\n';
+        throw std::runtime_error{msg};
+    }
+}
 #endif
-    );
-    auto const frag = gen_shader_module<glpp::ShaderType::Fragment>(sources.fragment
-#if !defined(NDEBUG)
-                                                                    ,
-                                                                    "Fragment",
-                                                                    _has_uniform_been_set
+
+#if defined(NDEBUG)
+static auto active_uniforms(GLuint program) -> std::vector<internal::UniformInfo>
+{
+    GLint count{0};
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+    GLint max_name_length{0};
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_name_length);
+
+    auto uniforms = std::vector<internal::UniformInfo>{};
+    uniforms.reserve(static_cast<size_t>(count));
+    auto name_buffer = std::string(static_cast<size_t>(max_name_length), '\0');
+    for (GLuint i = 0; i < static_cast<GLuint>(count); ++i)
+    {
+        GLsizei name_length{0};
+        GLint   size{0};
+        GLenum  type{0};
+        glGetActiveUniform(program, i, max_name_length, &name_length, &size, &type, name_buffer.data());
+        GLint const location = glGetUniformLocation(program, name_buffer.c_str());
+        if (location == -1) // Uniforms that live in a uniform block can't be set individually
+            continue;
+        auto name = std::string_view{name_buffer.data(), static_cast<size_t>(name_length)};
+        if (name.size() > 3 && name.substr(name.size() - 3) == "[0]") // Arrays are reported as "name[0]", but are set with "name"
+            name.remove_suffix(3);
+        uniforms.push_back({std::string{name}, location});
+    }
+    return uniforms;
+}
 #endif
-    );
-    auto const geom = gen_shader_module<glpp::ShaderType::Geometry>(sources.geometry
+
+Shader::Shader(ShaderSources const& sources)
+    : Shader{internal::prepare_shader_sources(sources), internal::DontWaitForCompilation{}}
+{
+    finish_compilation();
+}
+
+Shader::Shader(internal::PreparedShaderSources&& prepared_sources, internal::DontWaitForCompilation)
+    : _uniforms{std::move(prepared_sources.uniforms)}
+    , _stages_being_compiled{std::make_unique<internal::CompilingStages>()}
+{
+    internal::enable_parallel_shader_compile();
+    auto& stages     = *_stages_being_compiled;
+    stages.cache_key = internal::program_binary_cache_key(prepared_sources.sources);
+    if (internal::load_program_binary(*_program, stages.cache_key))
+    {
+        stages.has_been_loaded_from_cache = true;
+        return;
+    }
+    internal::prepare_program_for_binary_cache(*_program, stages.cache_key);
+    // We don't check for errors here: the driver can compile all the stages (and even several shaders) in parallel while we do something else, and we will only wait for it in finish_compilation()
+    auto const& sources = prepared_sources.sources;
+    start_compiling(stages.vertex, sources.vertex, _program);
+    start_compiling(stages.fragment, sources.fragment, _program);
+    start_compiling(stages.geometry, sources.geometry, _program);
+    start_compiling(stages.tessellation_control, sources.tessellation_control, _program);
+    start_compiling(stages.tessellation_evaluation, sources.tessellation_evaluation, _program);
+    _program.link();
+}
+
+/// Returns the type of the uniform (e.g. GL_FLOAT_VEC2), or 0 if it isn't an active uniform of the program.
+/// The elements of an array ("name[3]") have the type of the array.
+static auto uniform_type(GLuint program, std::string_view uniform_name) -> GLenum
+{
+    auto const without_subscript = [](std::string_view name) {
+        return name.empty() || name.back() != ']'
+                   ? name
+                   : name.substr(0, name.rfind('['));
+    };
+    uniform_name = without_subscript(uniform_name);
+
+    GLint count{0};
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+    GLint max_name_length{0};
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_name_length);
+    auto name_buffer = std::string(static_cast<size_t>(max_name_length), '\0');
+    for (GLuint i = 0; i < static_cast<GLuint>(count); ++i)
+    {
+        GLsizei name_length{0};
+        GLint   size{0};
+        GLenum  type{0};
+        glGetActiveUniform(program, i, max_name_length, &name_length, &size, &type, name_buffer.data());
+        if (without_subscript({name_buffer.data(), static_cast<size_t>(name_length)}) == uniform_name)
+            return type;
+    }
+    return 0;
+}
+
+void Shader::restore_uniforms_from(Shader const& previous_shader)
+{
+    auto uniforms = std::vector<internal::UniformInfo>{};
+    uniforms.reserve(std::max(_uniforms.size(), previous_shader._uniforms.size()));
+    for (auto const& previous_uniform : previous_shader._uniforms)
+    {
+        auto const it = std::find_if(_uniforms.begin(), _uniforms.end(), [&](internal::UniformInfo const& uniform) {
+            return uniform.name == previous_uniform.name;
+        });
+        auto uniform = internal::UniformInfo{previous_uniform.name, -1};
+        if (it != _uniforms.end())
+        {
+            uniform = std::move(*it);
+            _uniforms.erase(it);
+        }
+        else
+        {
+            // Not one of the uniforms we know of, but it can still exist (e.g. an element of an array, "name[3]", that find_uniform() looked up on demand)
+            uniform.location = glGetUniformLocation(*_program, uniform.name.c_str());
+            if (uniform.location == -1)
+            {
+                // It doesn't exist anymore. We keep a placeholder so that the indices of the next uniforms (and so the UniformHandles) stay the same,
+                // but without its name, so that setting it by name fails like it would with a freshly created shader.
+                uniform.name.clear();
 #if !defined(NDEBUG)
-                                                                    ,
-                                                                    "Geometry",
-                                                                    _has_uniform_been_set
+                uniform.has_been_set = true;
 #endif
-    );
-    auto const tess_ctrl = gen_shader_module<glpp::ShaderType::TessellationControl>(sources.tessellation_control
+            }
+        }
+        if (previous_uniform.upload_last_value
+            && uniform.location != -1
+            && uniform_type(*_program, uniform.name) == uniform_type(*previous_shader._program, previous_uniform.name)) // If the type has changed, the previous value can't be sent with the same glUniform* function
+        {
+            use();
+            previous_uniform.upload_last_value(uniform.location, previous_uniform.last_value.data());
+            uniform.last_value        = previous_uniform.last_value;
+            uniform.last_value_size   = previous_uniform.last_value_size;
+            uniform.upload_last_value = previous_uniform.upload_last_value;
 #if !defined(NDEBUG)
-                                                                                    ,
-                                                                                    "Tessellation Control",
-                                                                                    _has_uniform_been_set
+            uniform.has_been_set = previous_uniform.has_been_set;
 #endif
-    );
-    auto const tess_eval = gen_shader_module<glpp::ShaderType::TessellationEvaluation>(sources.tessellation_evaluation
+        }
+        uniforms.push_back(std::move(uniform));
+    }
+    // The new uniforms
+    std::move(_uniforms.begin(), _uniforms.end(), std::back_inserter(uniforms));
+    _uniforms = std::move(uniforms);
+}
+
+void Shader::mark_inactive_uniforms_as_set()
+{
 #if !defined(NDEBUG)
-                                                                                       ,
-                                                                                       "Tessellation Evaluation",
-                                                                                       _has_uniform_been_set
+    for (auto& uniform : _uniforms)
+    {
+        if (uniform.location == -1)
+            uniform.has_been_set = true;
+    }
 #endif
-    );
-    if (vert)
-        _program.attach_shader(vert->id());
-    if (frag)
-        _program.attach_shader(frag->id());
-    if (geom)
-        _program.attach_shader(geom->id());
-    if (tess_ctrl)
-        _program.attach_shader(tess_ctrl->id());
-    if (tess_eval)
-        _program.attach_shader(tess_eval->id());
-    _program.link();
-#if !defined(NDEBUG)
+}
+
+bool Shader::has_finished_compiling() const
+{
+    return !_stages_being_compiled
+           || internal::program_has_finished_linking(*_program);
+}
+
+void Shader::finish_compilation()
+{
+    if (!_stages_being_compiled)
+        return;
+    auto const stages = std::move(_stages_being_compiled); // Releases the stages even if we throw
+
+    if (!stages->has_been_loaded_from_cache)
     {
-        const auto err = _program.check_linking_errors();
-        if (err)
+#if !defined(NDEBUG)
+        throw_if_compilation_failed(stages->vertex, "Vertex");
+        throw_if_compilation_failed(stages->fragment, "Fragment");
+        throw_if_compilation_failed(stages->geometry, "Geometry");
+        throw_if_compilation_failed(stages->tessellation_control, "Tessellation Control");
+        throw_if_compilation_failed(stages->tessellation_evaluation, "Tessellation Evaluation");
         {
-            const auto msg = "Shader linking failed:\n" + err.message();
-            std::cerr << msg << '\n';
-            throw std::runtime_error{msg};
+            const auto err = _program.check_linking_errors();
+            if (err)
+            {
+                const auto msg = "Shader linking failed:\n" + err.message();
+                std::cerr << msg << '\n';
+                throw std::runtime_error{msg};
+            }
         }
+#endif
+        internal::save_program_binary(*_program, stages->cache_key);
     }
+
+#if !defined(NDEBUG)
+    for (auto& uniform : _uniforms)
+        uniform.location = glGetUniformLocation(*_program, uniform.name.c_str());
+#else
+    _uniforms = active_uniforms(*_program);
 #endif
+    auto const frame_data_block_index = glGetUniformBlockIndex(*_program, internal::frame_data_block_name.data());
+    if (frame_data_block_index != GL_INVALID_INDEX)
+        glUniformBlockBinding(*_program, frame_data_block_index, internal::frame_data_binding_point);
 }
 
 void Shader::check_for_errors_before_rendering() const
@@ -189,11 +442,11 @@ void Shader::check_for_errors_before_rendering() const
         std::cerr << msg << '\n';
         throw std::runtime_error{msg};
     }
-    for (auto const& [uniform_name, has_been_set] : _has_uniform_been_set)
+    for (auto const& uniform : _uniforms)
     {
-        if (has_been_set)
+        if (uniform.has_been_set)
             continue;
-        auto const msg = "Uniform \"" + uniform_name + "\" has not been set.";
+        auto const msg = "Uniform \"" + uniform.name + "\" has not been set.";
         std::cerr << msg << '\n';
         throw std::runtime_error{msg};
     }
@@ -202,133 +455,211 @@ void Shader::check_for_errors_before_rendering() const
 
 void Shader::use() const
 {
+    if (s_currently_used_program == *_program)
+        return;
     _program.use();
+    s_currently_used_program = *_program;
 }
 
-template<typename T>
-static void set_uniform(const glpp::ext::Program& program, std::string_view uniform_name, T&& value
+auto Shader::find_uniform(std::string_view uniform_name) const -> size_t
+{
+    // Shaders only have a handful of uniforms, so a linear search is faster than hashing the name
+    for (size_t i = 0; i < _uniforms.size(); ++i)
+    {
+        if (_uniforms[i].name == uniform_name)
+            return i;
+    }
 #if !defined(NDEBUG)
-                        ,
-                        std::unordered_map<std::string, bool>& has_uniform_been_set
+    auto const msg = "This uniform name \"" + std::string{uniform_name} + "\" does not exist in the shader.";
+    std::cerr << msg << '\n';
+    throw std::runtime_error{msg};
+#else
+    // e.g. an element of an array ("name[3]"), or a uniform that has been optimized away by the driver
+    auto       name     = std::string{uniform_name};
+    auto const location = glGetUniformLocation(*_program, name.c_str());
+    _uniforms.push_back({std::move(name), location});
+    return _uniforms.size() - 1;
 #endif
-)
+}
+
+bool Shader::has_uniform(std::string_view uniform_name) const
+{
+    return std::any_of(_uniforms.begin(), _uniforms.end(), [&](internal::UniformInfo const& uniform) {
+        return uniform.name == uniform_name;
+    });
+}
+
+UniformHandle Shader::uniform(std::string_view uniform_name) const
+{
+    return UniformHandle{find_uniform(uniform_name)};
+}
+
+static void upload_uniform(GLint location, int value)
+{
+    glUniform1i(location, value);
+}
+static void upload_uniform(GLint location, unsigned int value)
+{
+    glUniform1ui(location, value);
+}
+static void upload_uniform(GLint location, bool value)
+{
+    glUniform1i(location, value ? 1 : 0);
+}
+static void upload_uniform(GLint location, float value)
+{
+    glUniform1f(location, value);
+}
+static void upload_uniform(GLint location, const glm::vec2& value)
 {
+    glUniform2fv(location, 1, glm::value_ptr(value));
+}
+static void upload_uniform(GLint location, const glm::vec3& value)
+{
+    glUniform3fv(location, 1, glm::value_ptr(value));
+}
+static void upload_uniform(GLint location, const glm::vec4& value)
+{
+    glUniform4fv(location, 1, glm::value_ptr(value));
+}
+static void upload_uniform(GLint location, const glm::mat2& value)
+{
+    glUniformMatrix2fv(location, 1, GL_FALSE, glm::value_ptr(value));
+}
+static void upload_uniform(GLint location, const glm::mat3& value)
+{
+    glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(value));
+}
+static void upload_uniform(GLint location, const glm::mat4& value)
+{
+    glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
+}
+
+template<typename T>
+static void upload_uniform_from_bytes(GLint location, std::byte const* bytes)
+{
+    T value;
+    std::memcpy(&value, bytes, sizeof(T));
+    upload_uniform(location, value);
+}
+
+template<typename T>
+void Shader::set_uniform(size_t uniform_index, T const& value) const
+{
+    static_assert(sizeof(T) <= std::tuple_size_v<decltype(internal::UniformInfo::last_value)>);
+    auto& uniform = _uniforms[uniform_index];
 #if !defined(NDEBUG)
-    auto const it = has_uniform_been_set.find(std::string{uniform_name});
-    if (it == has_uniform_been_set.end())
-    {
-        auto const msg = "This uniform name \"" + std::string{uniform_name} + "\" does not exist in the shader.";
-        std::cerr << msg << '\n';
-        throw std::runtime_error{msg};
-    }
-    else
+    uniform.has_been_set = true;
+#endif
+    use(); // Even if we don't upload anything, users expect set() to make the shader current
+    if (uniform.last_value_size == sizeof(T)
+        && std::memcmp(uniform.last_value.data(), &value, sizeof(T)) == 0)
     {
-        it->second = true;
+        s_uniform_uploads_stats.elided++;
+        return;
     }
-#endif
-    program.use();
-    program.set(std::string{uniform_name}, value);
+    upload_uniform(uniform.location, value);
+    std::memcpy(uniform.last_value.data(), &value, sizeof(T));
+    uniform.last_value_size   = static_cast<uint8_t>(sizeof(T));
+    uniform.upload_last_value = &upload_uniform_from_bytes<T>;
+    s_uniform_uploads_stats.uploaded++;
 }
+
+void Shader::set_image(size_t uniform_index, const ImageOrCanvas& image) const
+{
+    image.texture().bind_to_texture_unit(s_available_texture_slot);
+    set_uniform(uniform_index, static_cast<int>(s_available_texture_slot)); // Samplers must be set with glUniform1i
+    s_available_texture_slot = (s_available_texture_slot + 1) % 8;
+}
+
 void Shader::set(std::string_view uniform_name, int value) const
 {
-    set_uniform(_program, uniform_name, value
-#if !defined(NDEBUG)
-                ,
-                _has_uniform_been_set
-#endif
-    );
+    set_uniform(find_uniform(uniform_name), value);
 }
 void Shader::set(std::string_view uniform_name, unsigned int value) const
 {
-    set_uniform(_program, uniform_name, value
-#if !defined(NDEBUG)
-                ,
-                _has_uniform_been_set
-#endif
-    );
+    set_uniform(find_uniform(uniform_name), value);
 }
 void Shader::set(std::string_view uniform_name, bool value) const
 {
-    set_uniform(_program, uniform_name, value
-#if !defined(NDEBUG)
-                ,
-                _has_uniform_been_set
-#endif
-    );
+    set_uniform(find_uniform(uniform_name), value);
 }
 void Shader::set(std::string_view uniform_name, float value) const
 {
-    set_uniform(_program, uniform_name, value
-#if !defined(NDEBUG)
-                ,
-                _has_uniform_been_set
-#endif
-    );
+    set_uniform(find_uniform(uniform_name), value);
 }
 void Shader::set(std::string_view uniform_name, const glm::vec2& value) const
 {
-    set_uniform(_program, uniform_name, value
-#if !defined(NDEBUG)
-                ,
-                _has_uniform_been_set
-#endif
-    );
+    set_uniform(find_uniform(uniform_name), value);
 }
 void Shader::set(std::string_view uniform_name, const glm::vec3& value) const
 {
-    set_uniform(_program, uniform_name, value
-#if !defined(NDEBUG)
-                ,
-                _has_uniform_been_set
-#endif
-    );
+    set_uniform(find_uniform(uniform_name), value);
 }
 void Shader::set(std::string_view uniform_name, const glm::vec4& value) const
 {
-    set_uniform(_program, uniform_name, value
-#if !defined(NDEBUG)
-                ,
-                _has_uniform_been_set
-#endif
-    );
+    set_uniform(find_uniform(uniform_name), value);
 }
 void Shader::set(std::string_view uniform_name, const glm::mat2& value) const
 {
-    set_uniform(_program, uniform_name, value
-#if !defined(NDEBUG)
-                ,
-                _has_uniform_been_set
-#endif
-    );
+    set_uniform(find_uniform(uniform_name), value);
 }
 void Shader::set(std::string_view uniform_name, const glm::mat3& value) const
 {
-    set_uniform(_program, uniform_name, value
-#if !defined(NDEBUG)
-                ,
-                _has_uniform_been_set
-#endif
-    );
+    set_uniform(find_uniform(uniform_name), value);
 }
 void Shader::set(std::string_view uniform_name, const glm::mat4& value) const
 {
-    set_uniform(_program, uniform_name, value
-#if !defined(NDEBUG)
-                ,
-                _has_uniform_been_set
-#endif
-    );
+    set_uniform(find_uniform(uniform_name), value);
 }
 void Shader::set(std::string_view uniform_name, const ImageOrCanvas& image) const
 {
-    image.texture().bind_to_texture_unit(s_available_texture_slot);
-    set_uniform(_program, uniform_name, s_available_texture_slot
-#if !defined(NDEBUG)
-                ,
-                _has_uniform_been_set
-#endif
-    );
-    s_available_texture_slot = (s_available_texture_slot + 1) % 8;
+    set_image(find_uniform(uniform_name), image);
+}
+
+void Shader::set(UniformHandle uniform, int value) const
+{
+    set_uniform(uniform._index, value);
+}
+void Shader::set(UniformHandle uniform, unsigned int value) const
+{
+    set_uniform(uniform._index, value);
+}
+void Shader::set(UniformHandle uniform, bool value) const
+{
+    set_uniform(uniform._index, value);
+}
+void Shader::set(UniformHandle uniform, float value) const
+{
+    set_uniform(uniform._index, value);
+}
+void Shader::set(UniformHandle uniform, const glm::vec2& value) const
+{
+    set_uniform(uniform._index, value);
+}
+void Shader::set(UniformHandle uniform, const glm::vec3& value) const
+{
+    set_uniform(uniform._index, value);
+}
+void Shader::set(UniformHandle uniform, const glm::vec4& value) const
+{
+    set_uniform(uniform._index, value);
+}
+void Shader::set(UniformHandle uniform, const glm::mat2& value) const
+{
+    set_uniform(uniform._index, value);
+}
+void Shader::set(UniformHandle uniform, const glm::mat3& value) const
+{
+    set_uniform(uniform._index, value);
+}
+void Shader::set(UniformHandle uniform, const glm::mat4& value) const
+{
+    set_uniform(uniform._index, value);
+}
+void Shader::set(UniformHandle uniform, const ImageOrCanvas& image) const
+{
+    set_image(uniform._index, image);
 }
 
 static auto file_content(std::filesystem::path const& path) -> std::string
@@ -345,6 +676,46 @@ static auto maybe_file_content(std::optional<std::filesystem::path> const& path)
     return file_content(*path);
 }
 
+ShaderVariantSet::ShaderVariantSet(std::string_view fragment_source_code)
+    : ShaderVariantSet{default_vertex_shader, fragment_source_code}
+{}
+
+ShaderVariantSet::ShaderVariantSet(std::string_view vertex_source_code, std::string_view fragment_source_code)
+    : ShaderVariantSet{ShaderSources{
+        /* .vertex   = */ std::string{vertex_source_code},
+        /* .fragment = */ std::string{fragment_source_code},
+    }}
+{}
+
+ShaderVariantSet::ShaderVariantSet(ShaderSources sources)
+    : _sources{std::move(sources)}
+{}
+
+ShaderVariantSet::ShaderVariantSet(std::string_view vertex_source_code, std::string_view fragment_source_code, internal::InactiveUniformsDontNeedToBeSet)
+    : ShaderVariantSet{vertex_source_code, fragment_source_code}
+{
+    _inactive_uniforms_dont_need_to_be_set = true;
+}
+
+Shader const& ShaderVariantSet::get(std::vector<std::string> defines) const
+{
+    std::sort(defines.begin(), defines.end()); // So that the same set of defines always gives the same variant (and the same program binary cache entry)
+    auto const it = _variants.find(defines);
+    if (it != _variants.end())
+        return *it->second;
+
+    auto shader = std::make_unique<Shader>(ShaderSources{
+        with_defines(_sources.vertex, defines),
+        with_defines(_sources.fragment, defines),
+        with_defines(_sources.geometry, defines),
+        with_defines(_sources.tessellation_control, defines),
+        with_defines(_sources.tessellation_evaluation, defines),
+    });
+    if (_inactive_uniforms_dont_need_to_be_set)
+        shader->mark_inactive_uniforms_as_set();
+    return *_variants.emplace(std::move(defines), std::move(shader)).first->second;
+}
+
 Shader load_shader(std::filesystem::path const& fragment_shader_path)
 {
     return Shader{file_content(fragment_shader_path)};
@@ -368,8 +739,153 @@ Shader load_shader(ShaderPaths const& paths)
 }
 
 namespace internal {
+struct PendingShaderState {
+    std::future<PreparedShaderSources> sources;
+    std::optional<Shader>              shader{};
+    std::exception_ptr                 error{};
+    bool                               is_ready_to_use{false};
+    bool                               has_been_taken{false};
+};
+} // namespace internal
+
+// The pending shaders whose source code might not have been sent to the driver yet
+static std::vector<std::weak_ptr<internal::PendingShaderState>> s_pending_shaders{};
+
+void PendingShader::start_compilation_if_sources_are_ready(internal::PendingShaderState& state, bool wait_for_sources)
+{
+    if (state.shader || state.error || state.has_been_taken)
+        return;
+    if (!wait_for_sources && state.sources.wait_for(std::chrono::seconds{0}) != std::future_status::ready)
+        return;
+    try
+    {
+        state.shader = Shader{state.sources.get(), internal::DontWaitForCompilation{}};
+    }
+    catch (...)
+    {
+        state.error = std::current_exception();
+    }
+}
+
+bool PendingShader::is_ready() const
+{
+    internal::start_compiling_pending_shaders();
+    return _state->is_ready_to_use
+           || _state->has_been_taken // get() won't wait, it will throw
+           || _state->error
+           || (_state->shader && _state->shader->has_finished_compiling());
+}
+
+Shader const& PendingShader::get() const
+{
+    if (_state->has_been_taken)
+        throw std::runtime_error{"[p6::PendingShader] The shader has already been moved out with take()."};
+    if (!_state->is_ready_to_use && !_state->error)
+    {
+        start_compilation_if_sources_are_ready(*_state, /*wait_for_sources=*/true);
+        if (!_state->error)
+        {
+            try
+            {
+                _state->shader->finish_compilation();
+                _state->is_ready_to_use = true;
+            }
+            catch (...)
+            {
+                _state->error = std::current_exception();
+            }
+        }
+    }
+    if (_state->error)
+        std::rethrow_exception(_state->error);
+    return *_state->shader;
+}
+
+namespace internal {
+/// Reads and prepares the source code of the shaders that are loaded asynchronously.
+/// Created the first time it is needed, so that apps that don't load shaders asynchronously don't pay for its threads.
+static auto shader_sources_readers() -> ThreadPool&
+{
+    static auto pool = ThreadPool{std::min<size_t>(ThreadPool::default_threads_count(), 4), std::numeric_limits<size_t>::max()}; // Loading shaders must never block the main thread
+    return pool;
+}
 
-static glm::vec2 get_scale(const glm::mat3& transform)
+auto make_pending_shader(std::function<ShaderSources()> read_sources) -> PendingShader
+{
+    auto state     = std::make_shared<PendingShaderState>();
+    auto promise   = std::make_shared<std::promise<PreparedShaderSources>>(); // std::function needs a copyable callable, so the promise is shared
+    state->sources = promise->get_future();
+    shader_sources_readers().push([promise, read_sources = std::move(read_sources)]() {
+        try
+        {
+            promise->set_value(prepare_shader_sources(read_sources()));
+        }
+        catch (...)
+        {
+            promise->set_exception(std::current_exception());
+        }
+    });
+    s_pending_shaders.push_back(state);
+    start_compiling_pending_shaders(); // Some shaders that have been requested earlier might be ready by now
+    return PendingShader{std::move(state)};
+}
+} // namespace internal
+
+Shader PendingShader::take()
+{
+    get();
+    auto shader = std::move(*_state->shader);
+    _state->shader.reset();
+    _state->has_been_taken = true;
+    return shader;
+}
+
+PendingShader load_shader_async(std::filesystem::path const& fragment_shader_path)
+{
+    return internal::make_pending_shader([=]() {
+        return ShaderSources{
+            /* .vertex   = */ default_vertex_shader,
+            /* .fragment = */ file_content(fragment_shader_path),
+        };
+    });
+}
+
+PendingShader load_shader_async(std::filesystem::path const& vertex_shader_path, std::filesystem::path const& fragment_shader_path)
+{
+    return internal::make_pending_shader([=]() {
+        return ShaderSources{
+            /* .vertex   = */ file_content(vertex_shader_path),
+            /* .fragment = */ file_content(fragment_shader_path),
+        };
+    });
+}
+
+PendingShader load_shader_async(ShaderPaths const& paths)
+{
+    return internal::make_pending_shader([=]() {
+        return ShaderSources{
+            maybe_file_content(paths.vertex),
+            maybe_file_content(paths.fragment),
+            maybe_file_content(paths.geometry),
+            maybe_file_content(paths.tessellation_control),
+            maybe_file_content(paths.tessellation_evaluation),
+        };
+    });
+}
+
+void enable_shader_cache(std::filesystem::path const& directory, std::uintmax_t max_size_in_bytes)
+{
+    internal::enable_program_binary_cache(make_absolute_path(directory), max_size_in_bytes);
+}
+
+void disable_shader_cache()
+{
+    internal::disable_program_binary_cache();
+}
+
+namespace internal {
+
+glm::vec2 get_scale(const glm::mat3& transform)
 {
     // Get the length of the first two columns of the 2x2 sub-matrix
     return glm::vec2{
@@ -381,7 +897,8 @@ static glm::vec2 get_scale(const glm::mat3& transform)
 void set_vertex_shader_uniforms(Shader const& shader, glm::mat3 const& transform, float framebuffer_aspect_ratio)
 {
     glm::vec2 const scale = get_scale(transform);
-    shader.set("_window_inverse_aspect_ratio", 1.0f / framebuffer_aspect_ratio);
+    if (shader.has_uniform("_window_inverse_aspect_ratio")) // The default vertex shader reads it from the frame data, but custom vertex shaders might still declare it
+        shader.set("_window_inverse_aspect_ratio", 1.0f / framebuffer_aspect_ratio);
     shader.set("_transform", transform);
     shader.set("_size", scale);
     if (scale.x == 0.f || scale.y == 0.f) // Avoid crash when aspect ratio implies a division by 0
@@ -389,6 +906,25 @@ void set_vertex_shader_uniforms(Shader const& shader, glm::mat3 const& transform
     shader.set("_aspect_ratio", scale.x / scale.y);
 }
 
+void start_compiling_pending_shaders()
+{
+    for (auto const& weak_state : s_pending_shaders)
+    {
+        if (auto const state = weak_state.lock())
+            PendingShader::start_compilation_if_sources_are_ready(*state, /*wait_for_sources=*/false);
+    }
+    s_pending_shaders.erase(std::remove_if(s_pending_shaders.begin(), s_pending_shaders.end(), [](std::weak_ptr<internal::PendingShaderState> const& weak_state) {
+                                auto const state = weak_state.lock();
+                                return !state || state->shader || state->error || state->has_been_taken;
+                            }),
+                            s_pending_shaders.end());
+}
+
+void forget_currently_used_program()
+{
+    s_currently_used_program = 0;
+}
+
 } // namespace internal
 
 } // namespace p6
@@ -1,9 +1,15 @@
 #pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
+#include <functional>
 #include <glpp/extended.hpp>
-#include <set>
+#include <map>
+#include <memory>
+#include <string>
 #include <string_view>
-#include <unordered_map>
+#include <vector>
 #include "ImageCommon.h"
 #include "Transform2D.h"
 
@@ -25,6 +31,88 @@ struct ShaderSources {
     std::optional<std::string> tessellation_evaluation{};
 };
 
+namespace internal {
+struct UniformInfo {
+    std::string name;
+    GLint       location;
+    /// A copy of the value that was last sent to the GPU, so that we don't send it again if it hasn't changed.
+    std::array<std::byte, sizeof(glm::mat4)> last_value{};
+    /// 0 iff no value has been sent yet.
+    uint8_t last_value_size{0};
+    /// Sends `last_value` again, with the right glUniform* function. Used to restore the values when a shader is reloaded.
+    void (*upload_last_value)(GLint location, std::byte const* value){nullptr};
+#if !defined(NDEBUG)
+    bool has_been_set{false};
+#endif
+};
+} // namespace internal
+
+class Shader;
+class PendingShader;
+
+namespace internal {
+/// Source code that is ready to be compiled: p6's declarations have been added, and (in debug) the names of the uniforms have been parsed.
+/// Preparing it doesn't need OpenGL, so it can be done on any thread.
+struct PreparedShaderSources {
+    ShaderSources            sources;
+    std::vector<UniformInfo> uniforms;
+};
+auto prepare_shader_sources(ShaderSources const& sources) -> PreparedShaderSources;
+
+/// The stages that have been sent to the driver, kept alive until we have checked their compilation errors.
+struct CompilingStages {
+    std::optional<glpp::internal::Shader<glpp::ShaderType::Vertex>>                 vertex{};
+    std::optional<glpp::internal::Shader<glpp::ShaderType::Fragment>>               fragment{};
+    std::optional<glpp::internal::Shader<glpp::ShaderType::Geometry>>               geometry{};
+    std::optional<glpp::internal::Shader<glpp::ShaderType::TessellationControl>>    tessellation_control{};
+    std::optional<glpp::internal::Shader<glpp::ShaderType::TessellationEvaluation>> tessellation_evaluation{};
+    std::optional<uint64_t>                                                         cache_key{};
+    bool                                                                            has_been_loaded_from_cache{false};
+};
+
+struct DontWaitForCompilation {};
+
+/// Used by p6's own shader variants: in debug, the uniforms that a variant doesn't use (because they are in a disabled #ifdef) don't have to be set.
+/// User shaders keep the check, because an unused uniform is often a typo.
+struct InactiveUniformsDontNeedToBeSet {};
+
+struct PendingShaderState;
+auto make_pending_shader(std::function<ShaderSources()> read_sources) -> PendingShader;
+/// Sends to the driver all the pending shaders whose source code has been read.
+void start_compiling_pending_shaders();
+} // namespace internal
+
+struct UniformUploadsStats {
+    /// Number of times a uniform has actually been sent to the GPU.
+    uint64_t uploaded{0};
+    /// Number of times setting a uniform has been skipped because it already had that value.
+    uint64_t elided{0};
+};
+
+/// Refers to one of the uniforms of a Shader. Get it with `shader.uniform("name")`.
+/// Setting a uniform through its handle doesn't need to search for its name, so prefer this for uniforms that you set very often (e.g. once per shape).
+/// :warning: A handle can only be used with the Shader that created it.
+class UniformHandle {
+private:
+    friend class Shader;
+    explicit UniformHandle(size_t index)
+        : _index{index}
+    {}
+
+    size_t _index;
+};
+
+/// All the shaders can read some data that p6 sends once per frame and per canvas, without you having to set it:
+/// ```glsl
+/// vec2  _canvas_size;                 // In pixels
+/// float _canvas_aspect_ratio;
+/// float _canvas_inverse_aspect_ratio;
+/// vec2  _mouse;                       // In the same coordinates as `ctx.mouse()`
+/// float _time;                        // Same as `ctx.time()`
+/// float _delta_time;                  // Same as `ctx.delta_time()`
+/// ```
+/// Just use them in your shader, p6 will declare them for you. (If you declare some of them yourself, e.g. as uniforms, p6 will leave those names alone and you will have to set them.)
+/// They live in a uniform block bound to binding point 0, so don't use that binding point for your own uniform blocks.
 class Shader {
 public:
     /// Throws std::runtime_error if there is an error while compiling the shader source code
@@ -47,6 +135,26 @@ public:
     /// :warning: You can have at most 8 images set at once. This is a limitation of the GPUs.
     void set(std::string_view uniform_name, const ImageOrCanvas& image) const;
 
+    /// Returns true iff the shader has a uniform with this name.
+    bool has_uniform(std::string_view uniform_name) const;
+
+    /// Looks up the uniform once, so that you can then set it with `set(handle, value)` as often as you want without searching for its name again.
+    /// Throws std::runtime_error (in debug) if the uniform doesn't exist in the shader.
+    UniformHandle uniform(std::string_view uniform_name) const;
+
+    void set(UniformHandle uniform, int value) const;
+    void set(UniformHandle uniform, unsigned int value) const;
+    void set(UniformHandle uniform, bool value) const;
+    void set(UniformHandle uniform, float value) const;
+    void set(UniformHandle uniform, const glm::vec2& value) const;
+    void set(UniformHandle uniform, const glm::vec3& value) const;
+    void set(UniformHandle uniform, const glm::vec4& value) const;
+    void set(UniformHandle uniform, const glm::mat2& value) const;
+    void set(UniformHandle uniform, const glm::mat3& value) const;
+    void set(UniformHandle uniform, const glm::mat4& value) const;
+    /// :warning: You can have at most 8 images set at once. This is a limitation of the GPUs.
+    void set(UniformHandle uniform, const ImageOrCanvas& image) const;
+
     /// Sets this as the current shader that will be used for rendering.
     void use() const;
 
@@ -57,12 +165,76 @@ public:
     /// You can call this just before a draw call (e.g. `glDrawArrays`) to check if your shader is set up properly (all textures have been set, etc.)
     void check_for_errors_before_rendering() const;
 
+    /// Setting a uniform to the value it already has doesn't send anything to the GPU.
+    /// This counts, across all shaders, how many uniforms have been sent and how many have been skipped since the last call to `reset_uniform_uploads_stats()`.
+    /// :warning: If you set a uniform with raw OpenGL calls on `id()`, p6 won't know about it. Use `set()` instead.
+    static UniformUploadsStats uniform_uploads_stats() { return s_uniform_uploads_stats; }
+    static void                reset_uniform_uploads_stats() { s_uniform_uploads_stats = {}; }
+
 private:
-    glpp::ext::Program _program;
-    static GLenum      s_available_texture_slot;
-#if !defined(NDEBUG)
-    mutable std::unordered_map<std::string, bool> _has_uniform_been_set{};
-#endif
+    friend class PendingShader;
+    friend class ShaderWatcher;
+    friend class ShaderVariantSet;
+    /// Sends the sources to the driver without waiting for the compilation to finish. `finish_compilation()` must be called before the shader is used.
+    Shader(internal::PreparedShaderSources&& prepared_sources, internal::DontWaitForCompilation);
+    bool has_finished_compiling() const;
+    /// Waits for the driver, checks for errors and looks up the uniforms.
+    void finish_compilation();
+    /// Gives our uniforms the values they had in `previous_shader`, and the same indices so that the UniformHandles created by `previous_shader` still work with us.
+    void restore_uniforms_from(Shader const& previous_shader);
+    /// In debug, marks the uniforms that don't affect the rendering as set, so that check_for_errors_before_rendering() doesn't require them.
+    void mark_inactive_uniforms_as_set();
+
+    auto find_uniform(std::string_view uniform_name) const -> size_t;
+    template<typename T>
+    void set_uniform(size_t uniform_index, T const& value) const;
+    void set_image(size_t uniform_index, const ImageOrCanvas& image) const;
+
+private:
+    glpp::ext::Program                         _program;
+    mutable std::vector<internal::UniformInfo> _uniforms{}; // The locations are looked up once and for all instead of each time a uniform is set
+    std::unique_ptr<internal::CompilingStages> _stages_being_compiled{};
+    static GLenum                              s_available_texture_slot;
+    static UniformUploadsStats                 s_uniform_uploads_stats;
+};
+
+/// Compiles the same source code with different sets of `#define`s, so that each combination of features gets its own specialized program instead of branching at runtime in every pixel.
+/// Each variant is compiled the first time it is requested, and then kept.
+///
+/// ```
+/// auto shaders = p6::ShaderVariantSet{R"(
+/// #version 410
+/// out vec4 _frag_color;
+/// void main() {
+/// #ifdef RED
+///     _frag_color = vec4(1., 0., 0., 1.);
+/// #else
+///     _frag_color = vec4(1.);
+/// #endif
+/// }
+/// )"};
+/// ctx.rectangle_with_shader(shaders.get({"RED"}), p6::FullScreen{});
+/// ```
+class ShaderVariantSet {
+public:
+    /// Uses p6's default vertex shader, like `Shader(fragment_source_code)`.
+    explicit ShaderVariantSet(std::string_view fragment_source_code);
+    ShaderVariantSet(std::string_view vertex_source_code, std::string_view fragment_source_code);
+    explicit ShaderVariantSet(ShaderSources sources);
+    ShaderVariantSet(std::string_view vertex_source_code, std::string_view fragment_source_code, internal::InactiveUniformsDontNeedToBeSet);
+
+    /// Returns the shader compiled with these defines, which are added at the beginning of each stage. A define can have a value, e.g. `"SAMPLES_COUNT 4"`.
+    /// The order of the defines doesn't matter.
+    /// Throws std::runtime_error if there is an error while compiling the shader source code.
+    Shader const& get(std::vector<std::string> defines) const;
+
+    /// Returns the number of variants that have been compiled so far.
+    size_t compiled_variants_count() const { return _variants.size(); }
+
+private:
+    ShaderSources                                                       _sources;
+    bool                                                                _inactive_uniforms_dont_need_to_be_set{false};
+    mutable std::map<std::vector<std::string>, std::unique_ptr<Shader>> _variants{}; // Behind a pointer so that references returned by get() stay valid when more variants are compiled
 };
 
 /// Loads a Shader from a file containing the fragment shader's source code.
@@ -80,10 +252,58 @@ private:
 /// Throws std::runtime_error if there is an error while compiling the shader source code.
 [[nodiscard]] Shader load_shader(ShaderPaths const& paths);
 
+/// A Shader that is being loaded and compiled in the background. Get one with `p6::load_shader_async()`.
+class PendingShader {
+public:
+    /// Returns true iff `get()` can return the shader without waiting.
+    bool is_ready() const;
+    /// Returns the shader, waiting for it to be loaded and compiled if necessary.
+    /// Throws std::runtime_error if there is an error while compiling the shader source code. Errors are only checked the first time you call this, so that checking them doesn't force the driver to finish compiling early.
+    Shader const& get() const;
+    /// Same as `get()`, but moves the shader out of the PendingShader. Calling `get()` or `take()` again afterwards throws std::runtime_error.
+    Shader take();
+
+private:
+    friend auto internal::make_pending_shader(std::function<ShaderSources()> read_sources) -> PendingShader;
+    friend void internal::start_compiling_pending_shaders();
+    explicit PendingShader(std::shared_ptr<internal::PendingShaderState> state)
+        : _state{std::move(state)}
+    {}
+    static void start_compilation_if_sources_are_ready(internal::PendingShaderState& state, bool wait_for_sources);
+
+private:
+    std::shared_ptr<internal::PendingShaderState> _state;
+};
+
+/// Same as `load_shader()`, except that it returns immediately: the files are read on another thread, and the compilation is only waited for when you call `get()` on the result.
+/// Start loading all your shaders before using any of them, so that they can be compiled in parallel (on drivers that support it).
+[[nodiscard]] PendingShader load_shader_async(std::filesystem::path const& fragment_shader_path);
+/// Same as `load_shader()`, except that it returns immediately: the files are read on another thread, and the compilation is only waited for when you call `get()` on the result.
+/// Start loading all your shaders before using any of them, so that they can be compiled in parallel (on drivers that support it).
+[[nodiscard]] PendingShader load_shader_async(std::filesystem::path const& vertex_shader_path, std::filesystem::path const& fragment_shader_path);
+/// Same as `load_shader()`, except that it returns immediately: the files are read on another thread, and the compilation is only waited for when you call `get()` on the result.
+/// Start loading all your shaders before using any of them, so that they can be compiled in parallel (on drivers that support it).
+[[nodiscard]] PendingShader load_shader_async(ShaderPaths const& paths);
+
+/// Compiling shaders takes a while, so p6 can save the compiled programs on disk and reuse them the next time your app starts (as long as the shaders' source code and the graphics driver haven't changed).
+/// This is disabled by default. Call this before creating your Context so that p6's own shaders benefit from it too.
+/// If the path is relative, it will be relative to the directory containing your executable.
+/// When the cache gets bigger than `max_size_in_bytes`, the programs that haven't been used for the longest time are removed.
+void enable_shader_cache(std::filesystem::path const& directory, std::uintmax_t max_size_in_bytes = 64 * 1024 * 1024);
+/// Stops reading and writing compiled programs on disk.
+void disable_shader_cache();
+
 namespace internal {
+/// Returns the scale factors along the x and y axes of the transform.
+glm::vec2 get_scale(const glm::mat3& transform);
+
 /// Set all needed uniforms for the p6 default vertex shader.
 void set_vertex_shader_uniforms(Shader const& shader, glm::mat3 const& transform, float framebuffer_aspect_ratio);
 
+/// p6 remembers which shader is in use so that it doesn't call glUseProgram when it is already the right one.
+/// This must be called whenever some code outside of p6 might have changed the program in use.
+void forget_currently_used_program();
+
 } // namespace internal
 
 } // namespace p6
@@ -0,0 +1,137 @@
+#include "ShaderWatcher.h"
+#include <algorithm>
+#include <iostream>
+#include <optional>
+#include "internal/FileWatcher.h"
+#include "make_absolute_path.h"
+
+namespace p6 {
+
+namespace internal {
+struct ShaderWatcherState {
+    ShaderWatcherState(Shader&& shader, std::vector<std::filesystem::path> const& paths, std::function<PendingShader()> load_next_version)
+        : shader{std::move(shader)}
+        , load_next_version{std::move(load_next_version)}
+        , file_watcher{paths}
+    {}
+
+    Shader                         shader;
+    std::function<PendingShader()> load_next_version;
+    FileWatcher                    file_watcher;
+    std::optional<PendingShader>   next_version{};
+    size_t                         reloads_count{0};
+};
+} // namespace internal
+
+// Only accessed from the main thread. The file watchers' threads only touch their own atomic flag.
+static std::vector<std::weak_ptr<internal::ShaderWatcherState>> s_shader_watchers{};
+
+static auto absolute_paths(std::vector<std::filesystem::path> const& paths) -> std::vector<std::filesystem::path>
+{
+    auto res = std::vector<std::filesystem::path>{};
+    std::transform(paths.begin(), paths.end(), std::back_inserter(res), &make_absolute_path);
+    return res;
+}
+
+ShaderWatcher::ShaderWatcher(std::vector<std::filesystem::path> const& paths, std::function<PendingShader()> load_next_version)
+{
+    auto first_version = load_next_version().take();
+    _state             = std::make_shared<internal::ShaderWatcherState>(std::move(first_version), absolute_paths(paths), std::move(load_next_version));
+    s_shader_watchers.push_back(_state);
+}
+
+Shader const& ShaderWatcher::shader() const
+{
+    return _state->shader;
+}
+
+size_t ShaderWatcher::reloads_count() const
+{
+    return _state->reloads_count;
+}
+
+static auto link_error(Shader const& shader) -> std::optional<std::string>
+{
+    GLint link_status{GL_FALSE};
+    glGetProgramiv(shader.id(), GL_LINK_STATUS, &link_status);
+    if (link_status == GL_TRUE)
+        return std::nullopt;
+    GLint length{0};
+    glGetProgramiv(shader.id(), GL_INFO_LOG_LENGTH, &length);
+    auto log = std::string(static_cast<size_t>(std::max(length, 1)), '\0');
+    glGetProgramInfoLog(shader.id(), length, nullptr, log.data());
+    return log;
+}
+
+void ShaderWatcher::update(internal::ShaderWatcherState& state)
+{
+    if (state.file_watcher.has_changed())
+        state.next_version = state.load_next_version(); // If the previous version is still compiling, we drop it in favor of the latest one
+
+    if (!state.next_version || !state.next_version->is_ready())
+        return;
+    auto next_version = std::move(*state.next_version);
+    state.next_version.reset();
+    try
+    {
+        auto shader = next_version.take();
+        // In release, Shader doesn't check for errors, but we don't want to replace a working shader with a broken one
+        if (auto const err = link_error(shader))
+        {
+            std::cerr << "[p6::ShaderWatcher] Shader compilation failed:\n"
+                      << *err << '\n';
+            return;
+        }
+        shader.restore_uniforms_from(state.shader);
+        state.shader = std::move(shader);
+        state.reloads_count++;
+    }
+    catch (std::exception const&)
+    {
+        // The error has already been printed by the Shader, and we keep using the previous version
+    }
+}
+
+namespace internal {
+void update_shader_watchers()
+{
+    s_shader_watchers.erase(std::remove_if(s_shader_watchers.begin(), s_shader_watchers.end(), [](std::weak_ptr<ShaderWatcherState> const& state) {
+                                return state.expired();
+                            }),
+                            s_shader_watchers.end());
+    for (auto const& weak_state : s_shader_watchers)
+    {
+        if (auto const state = weak_state.lock())
+            ShaderWatcher::update(*state);
+    }
+}
+} // namespace internal
+
+ShaderWatcher load_shader_hot(std::filesystem::path const& fragment_shader_path)
+{
+    return ShaderWatcher{{fragment_shader_path}, [=]() {
+                             return load_shader_async(fragment_shader_path);
+                         }};
+}
+
+ShaderWatcher load_shader_hot(std::filesystem::path const& vertex_shader_path, std::filesystem::path const& fragment_shader_path)
+{
+    return ShaderWatcher{{vertex_shader_path, fragment_shader_path}, [=]() {
+                             return load_shader_async(vertex_shader_path, fragment_shader_path);
+                         }};
+}
+
+ShaderWatcher load_shader_hot(ShaderPaths const& paths)
+{
+    auto all_paths = std::vector<std::filesystem::path>{};
+    for (auto const* path : {&paths.vertex, &paths.fragment, &paths.geometry, &paths.tessellation_control, &paths.tessellation_evaluation})
+    {
+        if (*path)
+            all_paths.push_back(**path);
+    }
+    return ShaderWatcher{all_paths, [=]() {
+                             return load_shader_async(paths);
+                         }};
+}
+
+} // namespace p6
@@ -0,0 +1,56 @@
+#pragma once
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "Shader.h"
+
+namespace p6 {
+
+namespace internal {
+struct ShaderWatcherState;
+/// Starts reloading the shaders whose files have changed, and swaps in the ones that have finished compiling.
+/// This is called by the Context at the beginning of each frame.
+void update_shader_watchers();
+} // namespace internal
+
+/// A Shader that is reloaded whenever one of its source files changes, so that you can see your changes without restarting your app. Get one with `p6::load_shader_hot()`.
+/// The new version is compiled in the background and replaces the old one at the beginning of a frame, once it is ready.
+/// If it fails to compile, the error is printed and the previous version is kept.
+/// The uniforms that still exist in the new version keep their values, and the UniformHandles you created still work.
+class ShaderWatcher {
+public:
+    /// The latest version of the shader that compiled successfully.
+    /// The reference stays valid when the shader is reloaded.
+    Shader const& shader() const;
+    Shader const& operator*() const { return shader(); }
+    Shader const* operator->() const { return &shader(); }
+
+    /// Returns the number of times the shader has been reloaded successfully.
+    size_t reloads_count() const;
+
+private:
+    friend void internal::update_shader_watchers();
+    friend ShaderWatcher load_shader_hot(std::filesystem::path const& fragment_shader_path);
+    friend ShaderWatcher load_shader_hot(std::filesystem::path const& vertex_shader_path, std::filesystem::path const& fragment_shader_path);
+    friend ShaderWatcher load_shader_hot(ShaderPaths const& paths);
+    ShaderWatcher(std::vector<std::filesystem::path> const& paths, std::function<PendingShader()> load_next_version);
+    static void update(internal::ShaderWatcherState& state);
+
+private:
+    std::shared_ptr<internal::ShaderWatcherState> _state;
+};
+
+/// Same as `load_shader()`, except that the shader will be reloaded whenever the file changes.
+/// Throws std::runtime_error if there is an error while compiling the initial version of the shader.
+[[nodiscard]] ShaderWatcher load_shader_hot(std::filesystem::path const& fragment_shader_path);
+
+/// Same as `load_shader()`, except that the shader will be reloaded whenever one of the files changes.
+/// Throws std::runtime_error if there is an error while compiling the initial version of the shader.
+[[nodiscard]] ShaderWatcher load_shader_hot(std::filesystem::path const& vertex_shader_path, std::filesystem::path const& fragment_shader_path);
+
+/// Same as `load_shader()`, except that the shader will be reloaded whenever one of the files changes.
+/// Throws std::runtime_error if there is an error while compiling the initial version of the shader.
+[[nodiscard]] ShaderWatcher load_shader_hot(ShaderPaths const& paths);
+
+} // namespace p6
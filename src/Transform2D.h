@@ -14,6 +14,16 @@ struct Transform2D {
 
 glm::mat3 as_matrix(const Transform2D&);
 
+struct Point2D {
+    glm::vec2 value;
+
+    Point2D(float x, float y)
+        : value{x, y} {}
+
+    Point2D(glm::vec2 value)
+        : value{value} {}
+};
+
 struct Center {
     glm::vec2 value{0.f};
 
@@ -0,0 +1,108 @@
+#include "FileWatcher.h"
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <optional>
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace p6::internal {
+
+FileWatcher::FileWatcher(std::vector<std::filesystem::path> paths)
+    : _paths{std::move(paths)}
+{
+#if defined(__linux__)
+    _thread = std::thread{[this]() { watch_with_inotify(); }};
+#else
+    _thread = std::thread{[this]() { watch_by_polling(); }};
+#endif
+}
+
+FileWatcher::~FileWatcher()
+{
+    _should_stop = true;
+    _thread.join();
+}
+
+static auto last_write_time_if_exists(std::filesystem::path const& path) -> std::optional<std::filesystem::file_time_type>
+{
+    std::error_code err;
+    auto const      time = std::filesystem::last_write_time(path, err);
+    if (err) // e.g. the file is being saved and doesn't exist for a short while
+        return std::nullopt;
+    return time;
+}
+
+void FileWatcher::watch_by_polling()
+{
+    auto last_write_times = std::vector<std::optional<std::filesystem::file_time_type>>{};
+    std::transform(_paths.begin(), _paths.end(), std::back_inserter(last_write_times), &last_write_time_if_exists);
+    while (!_should_stop)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds{250});
+        for (size_t i = 0; i < _paths.size(); ++i)
+        {
+            auto const time = last_write_time_if_exists(_paths[i]);
+            if (time && time != last_write_times[i])
+            {
+                last_write_times[i] = time;
+                _has_changed        = true;
+            }
+        }
+    }
+}
+
+void FileWatcher::watch_with_inotify()
+{
+#if defined(__linux__)
+    int const fd = inotify_init1(IN_NONBLOCK);
+    if (fd == -1)
+    {
+        watch_by_polling();
+        return;
+    }
+    // We watch the directories rather than the files because many editors save by writing a new file and renaming it, which would make a watch on the file itself stop working
+    auto watched_directories = std::vector<int>{};
+    for (auto const& path : _paths)
+    {
+        auto const directory = path.parent_path().empty() ? std::filesystem::path{"."} : path.parent_path();
+        int const  wd        = inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (wd == -1)
+        {
+            close(fd);
+            watch_by_polling();
+            return;
+        }
+        watched_directories.push_back(wd);
+    }
+
+    alignas(inotify_event) char buffer[4096];
+    while (!_should_stop)
+    {
+        auto poll_fd = pollfd{fd, POLLIN, 0};
+        if (poll(&poll_fd, 1, 100 /*ms*/) <= 0) // The timeout allows us to check _should_stop regularly
+            continue;
+        auto const length = read(fd, buffer, sizeof(buffer));
+        for (ssize_t offset = 0; offset < length;)
+        {
+            auto const* event = reinterpret_cast<inotify_event const*>(buffer + offset); // NOLINT
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+            if (event->len == 0)
+                continue;
+            for (size_t i = 0; i < _paths.size(); ++i)
+            {
+                if (watched_directories[i] == event->wd && _paths[i].filename() == event->name)
+                    _has_changed = true;
+            }
+        }
+    }
+    close(fd);
+#else
+    watch_by_polling();
+#endif
+}
+
+} // namespace p6::internal
@@ -0,0 +1,34 @@
+#pragma once
+#include <atomic>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+namespace p6::internal {
+
+/// Watches some files on a background thread, and remembers if any of them has changed.
+/// Uses inotify on Linux, and checks the files' modification time regularly on other platforms.
+class FileWatcher {
+public:
+    explicit FileWatcher(std::vector<std::filesystem::path> paths);
+    ~FileWatcher();
+    FileWatcher(FileWatcher const&)            = delete;
+    FileWatcher& operator=(FileWatcher const&) = delete;
+    FileWatcher(FileWatcher&&)                 = delete;
+    FileWatcher& operator=(FileWatcher&&)      = delete;
+
+    /// Returns true iff one of the files has changed since the last call to this function.
+    bool has_changed() { return _has_changed.exchange(false); }
+
+private:
+    void watch_with_inotify();
+    void watch_by_polling();
+
+private:
+    std::vector<std::filesystem::path> _paths;
+    std::atomic<bool>                  _has_changed{false};
+    std::atomic<bool>                  _should_stop{false};
+    std::thread                        _thread;
+};
+
+} // namespace p6::internal
@@ -0,0 +1,21 @@
+#include "FrameData.h"
+#include <cstring>
+
+namespace p6::internal {
+
+FrameDataBuffer::FrameDataBuffer()
+{
+    glBindBuffer(GL_UNIFORM_BUFFER, _buffer.id());
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), nullptr, GL_DYNAMIC_DRAW);
+}
+
+void FrameDataBuffer::upload(FrameData const& data)
+{
+    if (_last_uploaded_data && std::memcmp(&*_last_uploaded_data, &data, sizeof(FrameData)) == 0)
+        return;
+    glBindBufferBase(GL_UNIFORM_BUFFER, frame_data_binding_point, _buffer.id());
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameData), &data);
+    _last_uploaded_data = data;
+}
+
+} // namespace p6::internal
@@ -0,0 +1,63 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <glpp/glpp.hpp>
+#include <optional>
+#include <string_view>
+
+namespace p6::internal {
+
+/// The data that p6 shares with all the shaders through a uniform buffer.
+/// It is laid out with the std140 rules, and must match `frame_data_glsl_declaration`.
+struct FrameData {
+    glm::vec2 canvas_size;
+    float     canvas_aspect_ratio;
+    float     canvas_inverse_aspect_ratio;
+    glm::vec2 mouse;
+    float     time;
+    float     delta_time;
+};
+static_assert(sizeof(FrameData) == 32, "FrameData must match the std140 layout of the uniform block");
+
+/// The uniform block binding point that p6 reserves for the FrameData.
+static constexpr GLuint frame_data_binding_point = 0;
+
+static constexpr std::string_view frame_data_block_name = "_p6_FrameData";
+
+/// The members have reserved names, so that they never conflict with the ones declared by the user, even in another stage of the same program (all the stages share the same uniforms).
+/// Shaders read them through the names in `frame_data_members_names`, which are `#define`d to these ones.
+static constexpr std::string_view frame_data_glsl_declaration = R"(layout(std140) uniform _p6_FrameData {
+    vec2  _p6_canvas_size;
+    float _p6_canvas_aspect_ratio;
+    float _p6_canvas_inverse_aspect_ratio;
+    vec2  _p6_mouse;
+    float _p6_time;
+    float _p6_delta_time;
+};
+)";
+
+/// The names that shaders can use to read the FrameData. Each one is an alias for the member of `frame_data_glsl_declaration` that has the same name prefixed with `_p6`.
+static constexpr std::string_view frame_data_members_names[] = {
+    "_canvas_size",
+    "_canvas_aspect_ratio",
+    "_canvas_inverse_aspect_ratio",
+    "_mouse",
+    "_time",
+    "_delta_time",
+};
+
+/// Owns the uniform buffer that holds the FrameData.
+class FrameDataBuffer {
+public:
+    FrameDataBuffer();
+
+    /// Sends the data to the GPU, unless it is the same as what was sent last time.
+    void upload(FrameData const& data);
+    /// Forces the next upload to happen, e.g. because someone else might have bound another buffer to our binding point.
+    void invalidate() { _last_uploaded_data.reset(); }
+
+private:
+    glpp::UniqueBuffer       _buffer;
+    std::optional<FrameData> _last_uploaded_data{};
+};
+
+} // namespace p6::internal
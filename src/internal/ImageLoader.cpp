@@ -0,0 +1,111 @@
+#include "ImageLoader.h"
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include "../make_absolute_path.h"
+
+namespace p6::internal {
+
+AsyncImageState::AsyncImageState(std::filesystem::path path)
+    : path{std::move(path)}
+{
+    static constexpr std::array<uint8_t, 4> placeholder{128, 128, 128, 255};
+    texture.upload_data(size, placeholder.data(), {glpp::InternalFormat::RGBA8, glpp::Channels::RGBA, glpp::TexelDataType::UnsignedByte});
+}
+
+ImageLoader& ImageLoader::instance()
+{
+    static ImageLoader instance{};
+    return instance;
+}
+
+ImageLoader::~ImageLoader()
+{
+    {
+        std::lock_guard lock{_decoded_images_mutex};
+        _is_shutting_down = true; // Nobody will upload the decoded images anymore, so the decoders must not wait for it
+    }
+    _decoded_images_have_been_taken.notify_all();
+}
+
+std::shared_ptr<AsyncImageState> ImageLoader::load(std::filesystem::path const& path, bool flip_vertically)
+{
+    auto state = std::make_shared<AsyncImageState>(path);
+    if (!_decoders)
+        _decoders.emplace(ThreadPool::default_threads_count(), std::numeric_limits<size_t>::max()); // Loading a whole folder must never block the main thread
+    _decoders->push([this, weak_state = std::weak_ptr{state}, path, flip_vertically]() {
+        {
+            // Wait before decoding, so that the decoders don't hold the memory of images that can't be uploaded yet
+            std::unique_lock lock{_decoded_images_mutex};
+            _decoded_images_have_been_taken.wait(lock, [&]() { return _is_shutting_down || _decoded_images.size() < max_decoded_images; });
+            if (_is_shutting_down)
+                return;
+        }
+        if (weak_state.expired()) // No need to decode an image that nobody uses anymore
+            return;
+        auto decoded = DecodedImage{weak_state, std::nullopt, ""};
+        try
+        {
+            decoded.image.emplace(img::load(make_absolute_path(path), 4, flip_vertically));
+        }
+        catch (std::exception const& e)
+        {
+            decoded.error_message = e.what();
+        }
+        std::lock_guard lock{_decoded_images_mutex};
+        _decoded_images.push_back(std::move(decoded));
+        if (_image_decoded_callback)
+            _image_decoded_callback();
+    });
+    return state;
+}
+
+void ImageLoader::set_image_decoded_callback(std::function<void()> callback)
+{
+    std::lock_guard lock{_decoded_images_mutex};
+    _image_decoded_callback = std::move(callback);
+}
+
+bool ImageLoader::upload_decoded_images(float budget_in_seconds)
+{
+    const auto start  = std::chrono::steady_clock::now();
+    const auto budget = std::chrono::duration<float>{budget_in_seconds};
+
+    auto decoded_images = std::vector<DecodedImage>{};
+    {
+        std::lock_guard lock{_decoded_images_mutex};
+        if (_decoded_images.empty())
+            return false;
+        std::swap(decoded_images, _decoded_images);
+    }
+    _decoded_images_have_been_taken.notify_all();
+
+    auto it = decoded_images.begin();
+    for (; it != decoded_images.end(); ++it)
+    {
+        if (it != decoded_images.begin() && std::chrono::steady_clock::now() - start > budget)
+            break;
+        auto state = it->state.lock();
+        if (!state)
+            continue;
+        if (!it->image)
+        {
+            state->error_message = std::move(it->error_message);
+            std::cerr << "[p6::load_image_async] " << state->error_message << '\n';
+            continue;
+        }
+        state->size = ImageSize{static_cast<GLsizei>(it->image->size().width()),
+                                static_cast<GLsizei>(it->image->size().height())};
+        state->texture.upload_data(state->size, it->image->data(), {glpp::InternalFormat::RGBA8, glpp::Channels::RGBA, glpp::TexelDataType::UnsignedByte});
+        state->is_ready = true;
+    }
+
+    // Put back the ones we didn't have time to upload, before the ones that have been decoded in the meantime
+    std::lock_guard lock{_decoded_images_mutex};
+    _decoded_images.insert(_decoded_images.begin(), std::make_move_iterator(it), std::make_move_iterator(decoded_images.end()));
+    return !_decoded_images.empty();
+}
+
+} // namespace p6::internal
@@ -0,0 +1,65 @@
+#pragma once
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+#include "../Image.h"
+#include "ThreadPool.h"
+
+namespace p6::internal {
+
+struct AsyncImageState {
+    explicit AsyncImageState(std::filesystem::path path);
+
+    std::filesystem::path path;
+    glpp::Texture2D       texture{}; // Contains a placeholder until the image has been uploaded
+    ImageSize             size{1, 1};
+    bool                  is_ready{false};
+    std::string           error_message{};
+};
+
+/// Decodes images on a pool of worker threads, and uploads them to the GPU on the main thread, a few at a time so that no frame takes too long.
+class ImageLoader {
+public:
+    static ImageLoader& instance();
+    ~ImageLoader();
+    ImageLoader(ImageLoader const&)            = delete;
+    ImageLoader& operator=(ImageLoader const&) = delete;
+    ImageLoader(ImageLoader&&)                 = delete;
+    ImageLoader& operator=(ImageLoader&&)      = delete;
+
+    /// Must be called on the thread that owns the OpenGL context.
+    std::shared_ptr<AsyncImageState> load(std::filesystem::path const& path, bool flip_vertically);
+    /// Uploads the images that have been decoded, until `budget_in_seconds` has elapsed. At least one image is uploaded if any is ready, so that loading always makes progress.
+    /// Must be called regularly on the thread that owns the OpenGL context (the Context does it once per frame).
+    /// Returns true iff some decoded images are still waiting to be uploaded.
+    bool upload_decoded_images(float budget_in_seconds);
+    /// Sets the function that is called, from a worker thread, whenever an image has been decoded and is waiting to be uploaded.
+    void set_image_decoded_callback(std::function<void()> callback);
+
+private:
+    ImageLoader() = default;
+
+    struct DecodedImage {
+        std::weak_ptr<AsyncImageState> state; // The user might have destroyed the image while it was decoding, in which case there is no need to upload it
+        std::optional<img::Image>      image;
+        std::string                    error_message;
+    };
+
+    /// Decoded images take a lot of memory, so the decoders wait when this many are waiting to be uploaded.
+    static constexpr size_t max_decoded_images = 16;
+
+private:
+    std::vector<DecodedImage> _decoded_images{};
+    std::function<void()>     _image_decoded_callback{};
+    bool                      _is_shutting_down{false};
+    std::mutex                _decoded_images_mutex{}; // Protects _decoded_images, _image_decoded_callback and _is_shutting_down
+    std::condition_variable   _decoded_images_have_been_taken{};
+    std::optional<ThreadPool> _decoders{}; // Created on first use, so that apps that don't load images asynchronously don't pay for the threads. Must be destroyed first, because its threads use the other members
+};
+
+} // namespace p6::internal
@@ -0,0 +1,145 @@
+#include "ImageSaver.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <img/img.hpp>
+#include <mutex>
+#include <stdexcept>
+#include "encode_exr.h"
+#include "encode_ppm.h"
+#include "encode_qoi.h"
+#include "flip_rows_vertically.h"
+#include "make_directories_if_necessary.h"
+#include "make_output_path.h"
+#include "write_file.h"
+
+namespace p6::internal {
+
+ImageSaver& ImageSaver::instance()
+{
+    static auto instance = ImageSaver{};
+    return instance;
+}
+
+void ImageSaver::check_extension_is_supported(std::filesystem::path const& path)
+{
+    const auto extension = path.extension();
+    if (extension != ".png"
+        && extension != ".jpg"
+        && extension != ".jpeg"
+        && extension != ".qoi"
+        && extension != ".ppm"
+        && extension != ".rgba"
+        && extension != ".exr")
+    {
+        throw std::runtime_error{"[p6::save_image] Only supports .png, .jpeg, .jpg, .qoi, .ppm, .rgba and .exr extensions"};
+    }
+}
+
+GLenum ImageSaver::data_type_for(std::filesystem::path const& path)
+{
+    return path.extension() == ".exr" ? GL_HALF_FLOAT
+                                      : GL_UNSIGNED_BYTE;
+}
+
+void ImageSaver::write_image(std::filesystem::path const& path, ImageSize size, std::vector<uint8_t> const& data)
+{
+    const auto width     = static_cast<img::Size::DataType>(size.width());
+    const auto height    = static_cast<img::Size::DataType>(size.height());
+    const auto extension = path.extension();
+    if (extension == ".png")
+    {
+        img::save_png(path.string().c_str(), width, height, data.data(), 4);
+    }
+    else if (extension == ".jpg"
+             || extension == ".jpeg")
+    {
+        img::save_jpeg(path.string().c_str(), width, height, data.data(), 4);
+    }
+    else if (extension == ".qoi")
+    {
+        write_file(path, encode_qoi(data.data(), width, height, true));
+    }
+    else if (extension == ".ppm")
+    {
+        write_file(path, encode_ppm(data.data(), width, height, true));
+    }
+    else if (extension == ".rgba")
+    {
+        write_file(path, flip_rows_vertically(data, 4 * static_cast<size_t>(width)));
+    }
+    else if (extension == ".exr")
+    {
+        auto half_pixels = std::vector<uint16_t>(data.size() / sizeof(uint16_t));
+        std::memcpy(half_pixels.data(), data.data(), half_pixels.size() * sizeof(uint16_t));
+        write_file(path, encode_exr(half_pixels.data(), width, height, true));
+    }
+}
+
+std::future<std::filesystem::path> ImageSaver::save(Canvas const& canvas, std::filesystem::path path)
+{
+    check_extension_is_supported(path);
+    auto image = PendingImage{std::make_unique<PixelReadback>(), std::move(path), {}};
+    image.readback->start(canvas, data_type_for(image.path));
+    auto future = image.promise.get_future();
+    _pending_readbacks.push_back(std::move(image));
+    return future;
+}
+
+void ImageSaver::update()
+{
+    // Readbacks complete in the order they have been started, so we only need to look at the oldest ones
+    auto it = _pending_readbacks.begin();
+    while (it != _pending_readbacks.end() && it->readback->is_ready())
+    {
+        send_to_encoders(*it);
+        ++it;
+    }
+    _pending_readbacks.erase(_pending_readbacks.begin(), it);
+}
+
+void ImageSaver::finish()
+{
+    for (auto& image : _pending_readbacks)
+        send_to_encoders(image);
+    _pending_readbacks.clear();
+    if (_encoders)
+        _encoders->wait_until_idle();
+}
+
+void ImageSaver::send_to_encoders(PendingImage& image)
+{
+    auto size   = image.readback->size();
+    auto pixels = image.readback->finish();
+    // std::function needs a copyable callable, so the promise is shared
+    auto promise = std::make_shared<std::promise<std::filesystem::path>>(std::move(image.promise));
+    if (!_encoders)
+        _encoders.emplace(std::min<size_t>(ThreadPool::default_threads_count(), 4), 8); // Each queued image holds its pixels in memory, so we don't want too many of them. When the queue is full, save() waits: this is better than running out of memory.
+    _encoders->push([size, pixels = std::move(pixels), path = std::move(image.path), promise]() {
+        auto final_path = std::filesystem::path{};
+        try
+        {
+            final_path = [&]() {
+                static auto     mutex = std::mutex{}; // Two encoders must not pick the same path
+                std::lock_guard lock{mutex};
+                auto            res = make_output_path(path);
+                make_directories_if_necessary(res);
+                std::ofstream{res}; // Reserve the path, so that the next images don't pick it
+                return res;
+            }();
+            write_image(final_path, size, pixels);
+            promise->set_value(final_path);
+        }
+        catch (...)
+        {
+            if (!final_path.empty()) // Don't leave an empty or half-written file, which would also shift the numbering of the next images
+            {
+                std::error_code err;
+                std::filesystem::remove(final_path, err);
+            }
+            promise->set_exception(std::current_exception());
+        }
+    });
+}
+
+} // namespace p6::internal
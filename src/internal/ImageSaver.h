@@ -0,0 +1,48 @@
+#pragma once
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "../Canvas.h"
+#include "PixelReadback.h"
+#include "ThreadPool.h"
+
+namespace p6::internal {
+
+/// Saves canvases to disk without ever blocking the render thread on the GPU, the disk or the compression.
+/// The pixels are read back asynchronously, and once they have arrived they are handed to a pool of encoder threads, which also take care of choosing the final path and creating the directories.
+class ImageSaver {
+public:
+    static ImageSaver& instance();
+
+    /// Throws if the extension of `path` is not supported.
+    std::future<std::filesystem::path> save(Canvas const& canvas, std::filesystem::path path);
+    /// Sends the images whose pixels have arrived to the encoders. Must be called regularly (the Context does it once per frame).
+    void update();
+    /// Blocks until all the images have been written to disk. Must be called while the OpenGL context is still alive.
+    void finish();
+
+    /// Throws if p6 doesn't know how to save an image with this extension.
+    static void check_extension_is_supported(std::filesystem::path const& path);
+    /// The type of data the pixels must be read as, to be saved at `path`: GL_HALF_FLOAT for the formats that support high precision, GL_UNSIGNED_BYTE otherwise.
+    static GLenum data_type_for(std::filesystem::path const& path);
+    /// Writes the RGBA pixels (rows ordered from bottom to top, data type given by data_type_for()) into a file, using the format that corresponds to the extension of `path`.
+    static void write_image(std::filesystem::path const& path, ImageSize size, std::vector<uint8_t> const& data);
+
+private:
+    ImageSaver() = default;
+
+    struct PendingImage {
+        std::unique_ptr<PixelReadback>      readback;
+        std::filesystem::path               path;
+        std::promise<std::filesystem::path> promise;
+    };
+    void send_to_encoders(PendingImage& image);
+
+private:
+    std::vector<PendingImage> _pending_readbacks{};
+    std::optional<ThreadPool> _encoders{}; // Created on first use, so that apps that never save an image don't pay for the threads
+};
+
+} // namespace p6::internal
@@ -0,0 +1,60 @@
+#include "OpenGLStateTracker.h"
+
+namespace p6::internal {
+
+OpenGLState opengl_state_for_p6_rendering()
+{
+    auto state = OpenGLState{};
+    // Blend
+    state.blend_is_enabled = true;
+    state.blend_equation   = GL_FUNC_ADD;            // We use premultiplied alpha, which is the only convention that makes actual sense
+    state.src_rgb          = GL_ONE;                 // https://apoorvaj.io/alpha-compositing-opengl-blending-and-premultiplied-alpha/
+    state.dst_rgb          = GL_ONE_MINUS_SRC_ALPHA;
+    state.src_alpha        = GL_ONE;
+    state.dst_alpha        = GL_ONE_MINUS_SRC_ALPHA;
+    // Depth test
+    state.depth_test_is_enabled = false;
+    // Backface culling
+    state.backface_culling_is_enabled = false;
+    return state;
+}
+
+static void set_capability(GLenum capability, bool is_enabled)
+{
+    if (is_enabled)
+        glEnable(capability);
+    else
+        glDisable(capability);
+}
+
+void OpenGLStateTracker::apply(OpenGLState const& state)
+{
+    const auto is_known = _current_state.has_value();
+    const auto previous = _current_state.value_or(state);
+
+    // Blend
+    if (!is_known || previous.blend_is_enabled != state.blend_is_enabled)
+        set_capability(GL_BLEND, state.blend_is_enabled);
+    if (!is_known || previous.blend_equation != state.blend_equation)
+        glBlendEquation(state.blend_equation);
+    if (!is_known
+        || previous.src_rgb != state.src_rgb
+        || previous.dst_rgb != state.dst_rgb
+        || previous.src_alpha != state.src_alpha
+        || previous.dst_alpha != state.dst_alpha)
+    {
+        glBlendFuncSeparate(state.src_rgb, state.dst_rgb, state.src_alpha, state.dst_alpha);
+    }
+
+    // Depth test
+    if (!is_known || previous.depth_test_is_enabled != state.depth_test_is_enabled)
+        set_capability(GL_DEPTH_TEST, state.depth_test_is_enabled);
+
+    // Backface culling
+    if (!is_known || previous.backface_culling_is_enabled != state.backface_culling_is_enabled)
+        set_capability(GL_CULL_FACE, state.backface_culling_is_enabled);
+
+    _current_state = state;
+}
+
+} // namespace p6::internal
@@ -0,0 +1,41 @@
+#pragma once
+#include <glpp/glpp.hpp>
+#include <optional>
+
+namespace p6::internal {
+
+/// The parts of the OpenGL state that affect how p6 renders its shapes.
+struct OpenGLState {
+    // Blend
+    bool   blend_is_enabled;
+    GLenum blend_equation;
+    GLenum src_rgb;
+    GLenum dst_rgb;
+    GLenum src_alpha;
+    GLenum dst_alpha;
+
+    // Depth test
+    bool depth_test_is_enabled;
+
+    // Backface culling
+    bool backface_culling_is_enabled;
+};
+
+/// The state p6 needs for all its rendering.
+OpenGLState opengl_state_for_p6_rendering();
+
+/// Keeps a shadow copy of the OpenGL state so that we never need to query it,
+/// and only emit the OpenGL calls that actually change something.
+class OpenGLStateTracker {
+public:
+    /// Makes sure that `state` is the current OpenGL state.
+    void apply(OpenGLState const& state);
+    /// Forgets everything we know about the current state. Must be called whenever someone else might have changed the OpenGL state.
+    /// The next call to apply() will then set the whole state.
+    void invalidate() { _current_state.reset(); }
+
+private:
+    std::optional<OpenGLState> _current_state{};
+};
+
+} // namespace p6::internal
@@ -0,0 +1,107 @@
+#include "PathRenderer.h"
+
+namespace p6::internal {
+
+PathGeometry::PathGeometry()
+{
+    glBindVertexArray(vao.id());
+    glBindBuffer(GL_ARRAY_BUFFER, vbo.id());
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), nullptr);
+}
+
+void PathGeometry::upload(std::vector<glm::vec2> const& vertices, PolylineStyle const& new_style)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, vbo.id());
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertices.size() * sizeof(glm::vec2)), vertices.data(), GL_STATIC_DRAW);
+    vertices_count = static_cast<GLsizei>(vertices.size());
+    style          = new_style;
+}
+
+PathRenderer::PathRenderer()
+    : _shader{R"(
+#version 410
+
+layout(location = 0) in vec2 _vertex_position;
+
+uniform mat3 _transform;
+
+void main()
+{
+    vec3 pos3 = _transform * vec3(_vertex_position, 1.);
+    vec2 pos = pos3.xy / pos3.z;
+    pos.x *= _canvas_inverse_aspect_ratio;
+    gl_Position = vec4(pos, 0., 1.);
+}
+    )",
+              R"(
+#version 410
+out vec4 _frag_color;
+
+uniform vec4 _color;
+
+void main()
+{
+    _frag_color = _color;
+}
+    )"}
+{
+    glBindVertexArray(_streamed_vao.id());
+    glEnableVertexAttribArray(0);
+}
+
+void PathRenderer::render(Path const& path, PolylineStyle const& style, glm::mat3 const& transform, glm::vec4 const& color, OpenGLStateTracker& opengl_state)
+{
+    if (path.empty())
+        return;
+    auto [it, is_new] = _cached_paths.try_emplace(path.version());
+    auto& cached      = it->second;
+    if (is_new || cached.geometry.style != style)
+    {
+        _tessellated_vertices.clear();
+        for (auto const& contour : path.contours())
+            tessellate_polyline(contour.points, contour.is_closed, style, _tessellated_vertices);
+        cached.geometry.upload(_tessellated_vertices, style);
+    }
+    cached.last_used_frame = _frame_index;
+    render(cached.geometry.vao.id(), cached.geometry.vertices_count, transform, color, opengl_state);
+}
+
+void PathRenderer::end_frame()
+{
+    static constexpr uint64_t frames_before_eviction = 60; // Paths that are only drawn from time to time (e.g. when rendering on demand) don't need to be tessellated again each time
+    for (auto it = _cached_paths.begin(); it != _cached_paths.end();)
+    {
+        if (_frame_index - it->second.last_used_frame > frames_before_eviction)
+            it = _cached_paths.erase(it);
+        else
+            ++it;
+    }
+    _frame_index++;
+}
+
+void PathRenderer::render(std::vector<glm::vec2> const& vertices, glm::mat3 const& transform, glm::vec4 const& color, OpenGLStateTracker& opengl_state, StreamingBuffer& streaming_buffer)
+{
+    if (vertices.empty())
+        return;
+    const auto allocation = streaming_buffer.upload(vertices.data(), vertices.size() * sizeof(glm::vec2), alignof(glm::vec2));
+    glBindVertexArray(_streamed_vao.id());
+    glBindBuffer(GL_ARRAY_BUFFER, allocation.buffer);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), reinterpret_cast<void*>(allocation.offset)); // NOLINT
+    render(_streamed_vao.id(), static_cast<GLsizei>(vertices.size()), transform, color, opengl_state);
+}
+
+void PathRenderer::render(GLuint vao, GLsizei vertices_count, glm::mat3 const& transform, glm::vec4 const& color, OpenGLStateTracker& opengl_state) const
+{
+    if (vertices_count == 0)
+        return;
+    opengl_state.apply(opengl_state_for_p6_rendering());
+    _shader.use();
+    _shader.set(_transform, transform);
+    _shader.set(_color, color);
+    _shader.check_for_errors_before_rendering();
+    glBindVertexArray(vao);
+    glDrawArrays(GL_TRIANGLES, 0, vertices_count);
+}
+
+} // namespace p6::internal
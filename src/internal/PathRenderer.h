@@ -0,0 +1,56 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <glpp/glpp.hpp>
+#include <unordered_map>
+#include <vector>
+#include "../Path.h"
+#include "../Shader.h"
+#include "OpenGLStateTracker.h"
+#include "StreamingBuffer.h"
+#include "tessellate_polyline.h"
+
+namespace p6::internal {
+
+/// The triangles of a tessellated path, stored on the GPU so that they can be drawn again without re-tessellating the path.
+struct PathGeometry {
+    glpp::UniqueVertexArray vao;
+    glpp::UniqueBuffer      vbo;
+    GLsizei                 vertices_count{0};
+    PolylineStyle           style{}; // The style the path has been tessellated with. If it changes, we need to tessellate again.
+
+    PathGeometry();
+    void upload(std::vector<glm::vec2> const& vertices, PolylineStyle const& style);
+};
+
+/// Renders tessellated lines with a single color.
+class PathRenderer {
+public:
+    PathRenderer();
+
+    /// Renders a path. Its triangles are kept on the GPU, and reused as long as the path (identified by its version) and the style don't change.
+    void render(Path const& path, PolylineStyle const& style, glm::mat3 const& transform, glm::vec4 const& color, OpenGLStateTracker& opengl_state);
+    /// Renders geometry that will only be used once.
+    void render(std::vector<glm::vec2> const& vertices, glm::mat3 const& transform, glm::vec4 const& color, OpenGLStateTracker& opengl_state, StreamingBuffer& streaming_buffer);
+
+    /// Frees the triangles of the paths that haven't been drawn for a while. Must be called once per frame.
+    void end_frame();
+
+private:
+    void render(GLuint vao, GLsizei vertices_count, glm::mat3 const& transform, glm::vec4 const& color, OpenGLStateTracker& opengl_state) const;
+
+private:
+    struct CachedPath {
+        PathGeometry geometry{};
+        uint64_t     last_used_frame{0};
+    };
+    std::unordered_map<uint64_t, CachedPath> _cached_paths{}; // Indexed by the version of the path. We never learn when a Path is destroyed, so the ones that are not drawn anymore are removed by end_frame().
+    uint64_t                                 _frame_index{0};
+    std::vector<glm::vec2>                   _tessellated_vertices{}; // Kept around to avoid reallocating each time we tessellate a path
+
+    glpp::UniqueVertexArray _streamed_vao{};
+    Shader                  _shader;
+    UniformHandle           _transform{_shader.uniform("_transform")};
+    UniformHandle           _color{_shader.uniform("_color")};
+};
+
+} // namespace p6::internal
@@ -0,0 +1,64 @@
+#include "PixelReadback.h"
+#include <cassert>
+#include <cstring>
+#include "flush_pending_draws.h"
+
+namespace p6::internal {
+
+PixelReadback::~PixelReadback()
+{
+    if (_fence)
+        glDeleteSync(_fence);
+}
+
+void PixelReadback::start(Canvas const& canvas, GLenum data_type)
+{
+    assert(!is_pending());
+    flush_pending_draws();
+    _size = canvas.size();
+
+    GLint previous_framebuffer;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previous_framebuffer);
+    glpp::bind_framebuffer_as_read(canvas.render_target().framebuffer());
+
+    const auto bytes_per_channel = data_type == GL_UNSIGNED_BYTE ? size_t{1} : size_t{2};
+    const auto size_in_bytes     = 4 * bytes_per_channel * static_cast<size_t>(_size.width()) * static_cast<size_t>(_size.height());
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, _pbo.id());
+    if (size_in_bytes != _pbo_size)
+    {
+        glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(size_in_bytes), nullptr, GL_STREAM_READ);
+        _pbo_size = size_in_bytes;
+    }
+    glReadPixels(0, 0, _size.width(), _size.height(), GL_RGBA, data_type, nullptr); // Returns immediately because the destination is a buffer on the GPU
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);                                           // Otherwise the other calls to glReadPixels would write into our buffer
+    _fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    glpp::bind_framebuffer_as_read(static_cast<GLuint>(previous_framebuffer));
+}
+
+bool PixelReadback::is_ready()
+{
+    if (!_fence)
+        return false;
+    const auto status = glClientWaitSync(_fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0); // The flush makes sure that the fence will eventually be signaled even if nothing else flushes the commands
+    return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+}
+
+std::vector<uint8_t> PixelReadback::finish()
+{
+    assert(is_pending());
+    while (glClientWaitSync(_fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000'000) == GL_TIMEOUT_EXPIRED) {}
+    glDeleteSync(_fence);
+    _fence = nullptr;
+
+    auto pixels = std::vector<uint8_t>(_pbo_size);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, _pbo.id());
+    const auto* memory = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(_pbo_size), GL_MAP_READ_BIT);
+    if (memory)
+        std::memcpy(pixels.data(), memory, _pbo_size);
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return pixels;
+}
+
+} // namespace p6::internal
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <glpp/glpp.hpp>
+#include <vector>
+#include "../Canvas.h"
+
+namespace p6::internal {
+
+/// Copies the pixels of a canvas into a pixel buffer object, so that reading them doesn't stall the GPU pipeline.
+/// The copy is only queued by start(), and a fence tells us when it is done, typically one or two frames later.
+/// The same object can be reused for many readbacks, which allows the buffer to be reused too.
+class PixelReadback {
+public:
+    PixelReadback() = default;
+    ~PixelReadback();
+    PixelReadback(PixelReadback const&)            = delete;
+    PixelReadback& operator=(PixelReadback const&) = delete;
+    PixelReadback(PixelReadback&&)                 = delete;
+    PixelReadback& operator=(PixelReadback&&)      = delete;
+
+    /// Queues the copy of the pixels of the canvas, as RGBA, with the rows ordered from bottom to top (like OpenGL does).
+    /// `data_type` can be GL_UNSIGNED_BYTE, or GL_UNSIGNED_SHORT / GL_HALF_FLOAT to keep the full precision of the canvas.
+    /// :warning: The previous readback must have been finished.
+    void start(Canvas const& canvas, GLenum data_type = GL_UNSIGNED_BYTE);
+    /// Returns true iff a readback has been started and not finished yet.
+    bool is_pending() const { return _fence != nullptr; }
+    /// Returns true iff the pixels have arrived, i.e. finish() won't block.
+    bool is_ready();
+    /// Returns the pixels. Blocks until they have arrived if necessary.
+    std::vector<uint8_t> finish();
+
+    /// The size of the canvas that has been read by the last call to start().
+    ImageSize size() const { return _size; }
+
+private:
+    glpp::UniqueBuffer _pbo;
+    size_t             _pbo_size{0};
+    GLsync             _fence{nullptr};
+    ImageSize          _size{0, 0};
+};
+
+} // namespace p6::internal
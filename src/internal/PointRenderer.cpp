@@ -0,0 +1,94 @@
+#include "PointRenderer.h"
+
+namespace p6::internal {
+
+static_assert(sizeof(Color) == 4 * sizeof(float), "Colors are uploaded as-is to the GPU, so they must be exactly 4 floats.");
+
+PointRenderer::PointRenderer()
+    : _shader{R"(
+#version 410
+
+layout(location = 0) in vec2 _point_position;
+layout(location = 1) in float _point_radius;
+layout(location = 2) in vec4 _point_color; // Straight alpha
+
+uniform mat3 _transform;
+
+out vec2 _uv;
+flat out vec4 _color;
+
+void main()
+{
+    // Generate the corners of the quad, so that we don't need a vertex buffer for them
+    _uv = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2. - 1.;
+    vec3 pos3 = _transform * vec3(_point_position + _point_radius * _uv, 1.);
+    vec2 pos = pos3.xy / pos3.z;
+    pos.x *= _canvas_inverse_aspect_ratio;
+    gl_Position = vec4(pos, 0., 1.);
+    _color = vec4(_point_color.rgb * _point_color.a, _point_color.a);
+}
+    )",
+              R"(
+#version 410
+
+in vec2 _uv;
+flat in vec4 _color;
+out vec4 _frag_color;
+
+void main()
+{
+    float dist = length(_uv) - 1.;
+    float aa = fwidth(dist);
+    _frag_color = _color * (1. - smoothstep(-aa, 0., dist));
+}
+    )"}
+{
+    glBindVertexArray(_vao.id());
+    for (GLuint location = 0; location <= 2; ++location)
+        glVertexAttribDivisor(location, 1);
+}
+
+/// Reads the attribute from the streamed array, or uses the same value for all the points if there is only one.
+template<typename T>
+static void set_point_attribute(GLuint location, GLint components_count, std::vector<T> const& values, StreamingBuffer& streaming_buffer)
+{
+    if (values.size() == 1)
+    {
+        glDisableVertexAttribArray(location);
+        auto const* components = reinterpret_cast<float const*>(&values[0]); // NOLINT
+        glVertexAttrib4f(location,
+                         components[0],
+                         components_count > 1 ? components[1] : 0.f,
+                         components_count > 2 ? components[2] : 0.f,
+                         components_count > 3 ? components[3] : 1.f);
+        return;
+    }
+    const auto allocation = streaming_buffer.upload(values.data(), values.size() * sizeof(T), alignof(T));
+    glBindBuffer(GL_ARRAY_BUFFER, allocation.buffer);
+    glEnableVertexAttribArray(location);
+    glVertexAttribPointer(location, components_count, GL_FLOAT, GL_FALSE, sizeof(T), reinterpret_cast<void*>(allocation.offset)); // NOLINT
+}
+
+void PointRenderer::render(std::vector<glm::vec2> const& positions,
+                           std::vector<float> const&     radii,
+                           std::vector<Color> const&     colors,
+                           glm::mat3 const&              transform,
+                           OpenGLStateTracker&           opengl_state,
+                           StreamingBuffer&              streaming_buffer) const
+{
+    if (positions.empty())
+        return;
+    opengl_state.apply(opengl_state_for_p6_rendering());
+
+    glBindVertexArray(_vao.id());
+    set_point_attribute(0, 2, positions, streaming_buffer);
+    set_point_attribute(1, 1, radii, streaming_buffer);
+    set_point_attribute(2, 4, colors, streaming_buffer);
+
+    _shader.use();
+    _shader.set(_transform, transform);
+    _shader.check_for_errors_before_rendering();
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(positions.size()));
+}
+
+} // namespace p6::internal
@@ -0,0 +1,32 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <glpp/glpp.hpp>
+#include <vector>
+#include "../Color.h"
+#include "../Shader.h"
+#include "OpenGLStateTracker.h"
+#include "StreamingBuffer.h"
+
+namespace p6::internal {
+
+/// Renders many discs in a single instanced draw call.
+/// Positions, radii and colors are read from three separate arrays, that are each uploaded with a single copy.
+class PointRenderer {
+public:
+    PointRenderer();
+
+    /// `radii` and `colors` must either have the same size as `positions`, or contain a single element that is used for all the points.
+    void render(std::vector<glm::vec2> const& positions,
+                std::vector<float> const&     radii,
+                std::vector<Color> const&     colors,
+                glm::mat3 const&              transform,
+                OpenGLStateTracker&           opengl_state,
+                StreamingBuffer&              streaming_buffer) const;
+
+private:
+    glpp::UniqueVertexArray _vao;
+    Shader                  _shader;
+    UniformHandle           _transform{_shader.uniform("_transform")};
+};
+
+} // namespace p6::internal
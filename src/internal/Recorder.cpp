@@ -0,0 +1,191 @@
+#include "Recorder.h"
+#include <algorithm>
+#include <cmath>
+#include <img/img.hpp>
+#include <stdexcept>
+#include <string>
+#include "encode_qoi.h"
+#include "flip_rows_vertically.h"
+#include "make_directories_if_necessary.h"
+#include "make_output_path.h"
+#include "write_file.h"
+
+namespace p6::internal {
+
+static auto is_video(RecordingFormat format) -> bool
+{
+    return format == RecordingFormat::Y4M
+           || format == RecordingFormat::RawRGBA;
+}
+
+Recorder::Recorder(std::filesystem::path const& path, float framerate, RecordingFormat format)
+    : _path{make_output_path(path)}
+    , _framerate{framerate}
+    , _format{format}
+    , _encoders{ThreadPool::default_threads_count(), ThreadPool::default_threads_count() + 2} // Keeps at most a few frames in memory, and slows down the rendering if the encoders can't keep up
+{
+    if (is_video(_format))
+    {
+        make_directories_if_necessary(_path);
+        _video_file.open(_path, std::ios::binary);
+        if (!_video_file)
+            throw std::runtime_error{"[p6::Context::start_recording] Could not open \"" + _path.string() + "\" for writing."};
+    }
+    else
+    {
+        std::filesystem::create_directories(_path);
+    }
+}
+
+Recorder::~Recorder()
+{
+    for (size_t i = 0; i < frames_in_flight; ++i) // Starting with the oldest frame, so that they are written in order
+    {
+        auto& readback = _readbacks[(_next_readback + i) % frames_in_flight];
+        if (readback.is_pending())
+            send_to_encoders(readback);
+    }
+    _encoders.wait_until_idle();
+}
+
+void Recorder::capture(Canvas const& canvas)
+{
+    auto& readback = _readbacks[_next_readback];
+    if (readback.is_pending()) // It was started frames_in_flight frames ago, so it is almost always ready by now
+        send_to_encoders(readback);
+
+    if (is_video(_format))
+    {
+        if (!_video_size)
+        {
+            _video_size = canvas.size();
+            if (_format == RecordingFormat::Y4M)
+            {
+                const auto is_integer = std::round(_framerate) == _framerate;
+                const auto header     = "YUV4MPEG2 W" + std::to_string(_video_size->width())
+                                    + " H" + std::to_string(_video_size->height())
+                                    + (is_integer ? " F" + std::to_string(static_cast<int>(_framerate)) + ":1"
+                                                  : " F" + std::to_string(static_cast<int>(std::round(_framerate * 1000.f))) + ":1000")
+                                    + " Ip A1:1 C420jpeg\n";
+                std::lock_guard lock{_video_file_mutex};
+                _video_file << header;
+            }
+        }
+        else if (*_video_size != canvas.size())
+        {
+            throw std::runtime_error{"[p6::Context::start_recording] The size of the canvas can't change while recording a video. Use a fixed canvas size with `ctx.main_canvas_mode(p6::CanvasSizeMode_FixedSize{...})`, or record an image sequence."};
+        }
+    }
+
+    readback.start(canvas);
+    _next_readback = (_next_readback + 1) % frames_in_flight;
+    _frames_count++;
+}
+
+void Recorder::send_to_encoders(PixelReadback& readback)
+{
+    const auto size        = readback.size();
+    const auto frame_index = _frames_sent_to_encoders++;
+    _encoders.push([this, pixels = readback.finish(), size, frame_index]() {
+        encode(pixels, size, frame_index);
+    });
+}
+
+/// Converts to BT.601 YUV 4:2:0, with the rows ordered from top to bottom.
+static auto to_y4m_frame(std::vector<uint8_t> const& pixels, ImageSize size) -> std::vector<uint8_t>
+{
+    const auto width         = static_cast<size_t>(size.width());
+    const auto height        = static_cast<size_t>(size.height());
+    const auto chroma_width  = (width + 1) / 2;
+    const auto chroma_height = (height + 1) / 2;
+
+    static constexpr char frame_header[] = "FRAME\n";
+    const auto            header_size    = sizeof(frame_header) - 1;
+
+    auto out = std::vector<uint8_t>(header_size + width * height + 2 * chroma_width * chroma_height);
+    std::copy(frame_header, frame_header + header_size, out.begin()); // NOLINT(*-pointer-arithmetic)
+    auto* const y_plane = out.data() + header_size;                  // NOLINT(*-pointer-arithmetic)
+    auto* const u_plane = y_plane + width * height;                   // NOLINT(*-pointer-arithmetic)
+    auto* const v_plane = u_plane + chroma_width * chroma_height;     // NOLINT(*-pointer-arithmetic)
+
+    const auto pixel = [&](size_t x, size_t y) { // y goes from top to bottom, while OpenGL gives us the rows from bottom to top
+        return &pixels[4 * ((height - 1 - y) * width + x)];
+    };
+
+    for (size_t y = 0; y < height; ++y)
+    {
+        for (size_t x = 0; x < width; ++x)
+        {
+            auto const* px         = pixel(x, y);
+            y_plane[y * width + x] = static_cast<uint8_t>(((66 * px[0] + 129 * px[1] + 25 * px[2] + 128) >> 8) + 16); // NOLINT(*-pointer-arithmetic)
+        }
+    }
+    for (size_t cy = 0; cy < chroma_height; ++cy)
+    {
+        for (size_t cx = 0; cx < chroma_width; ++cx)
+        {
+            // Average the 2x2 block of pixels (which can be smaller on the right and bottom edges)
+            int r = 0, g = 0, b = 0, count = 0;
+            for (size_t y = 2 * cy; y < std::min(2 * cy + 2, height); ++y)
+            {
+                for (size_t x = 2 * cx; x < std::min(2 * cx + 2, width); ++x)
+                {
+                    auto const* px = pixel(x, y);
+                    r += px[0]; // NOLINT(*-pointer-arithmetic)
+                    g += px[1]; // NOLINT(*-pointer-arithmetic)
+                    b += px[2]; // NOLINT(*-pointer-arithmetic)
+                    count++;
+                }
+            }
+            r /= count;
+            g /= count;
+            b /= count;
+            // The offsets are added before shifting so that we never shift a negative number
+            u_plane[cy * chroma_width + cx] = static_cast<uint8_t>((-38 * r - 74 * g + 112 * b + 128 + (128 << 8)) >> 8); // NOLINT(*-pointer-arithmetic)
+            v_plane[cy * chroma_width + cx] = static_cast<uint8_t>((112 * r - 94 * g - 18 * b + 128 + (128 << 8)) >> 8);  // NOLINT(*-pointer-arithmetic)
+        }
+    }
+    return out;
+}
+
+void Recorder::encode(std::vector<uint8_t> const& pixels, ImageSize size, uint64_t frame_index)
+{
+    const auto width  = static_cast<uint32_t>(size.width());
+    const auto height = static_cast<uint32_t>(size.height());
+    switch (_format)
+    {
+    case RecordingFormat::PngSequence:
+        img::save_png(image_path(frame_index).string().c_str(), width, height, pixels.data(), 4);
+        break;
+    case RecordingFormat::QoiSequence:
+        write_file(image_path(frame_index), encode_qoi(pixels.data(), width, height, true));
+        break;
+    case RecordingFormat::Y4M:
+        write_in_order(to_y4m_frame(pixels, size), frame_index);
+        break;
+    case RecordingFormat::RawRGBA:
+        write_in_order(flip_rows_vertically(pixels, 4 * static_cast<size_t>(size.width())), frame_index);
+        break;
+    }
+}
+
+void Recorder::write_in_order(std::vector<uint8_t> const& data, uint64_t frame_index)
+{
+    {
+        std::unique_lock lock{_video_file_mutex};
+        _video_file_is_available.wait(lock, [&]() { return _next_frame_to_write == frame_index; });
+        _video_file.write(reinterpret_cast<char const*>(data.data()), static_cast<std::streamsize>(data.size())); // NOLINT(*-reinterpret-cast)
+        _next_frame_to_write++;
+    }
+    _video_file_is_available.notify_all();
+}
+
+std::filesystem::path Recorder::image_path(uint64_t frame_index) const
+{
+    auto number = std::to_string(frame_index);
+    if (number.size() < 6)
+        number.insert(0, 6 - number.size(), '0'); // So that the files are sorted properly by the file explorers and by ffmpeg
+    return _path / ("frame_" + number + (_format == RecordingFormat::PngSequence ? ".png" : ".qoi"));
+}
+
+} // namespace p6::internal
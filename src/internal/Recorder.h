@@ -0,0 +1,78 @@
+#pragma once
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include "../Canvas.h"
+#include "PixelReadback.h"
+#include "ThreadPool.h"
+
+namespace p6 {
+
+enum class RecordingFormat {
+    /// One .png file per frame. Small files, but slow to encode.
+    PngSequence,
+    /// One .qoi file per frame (https://qoiformat.org). Lossless like PNG, and many times faster to encode.
+    QoiSequence,
+    /// A single .y4m video file (YUV 4:2:0, uncompressed). Most video tools can read it, e.g. `ffmpeg -i video.y4m video.mp4`.
+    Y4M,
+    /// A single file containing the raw RGBA 8-bit pixels of all the frames, one after the other.
+    /// Read it with e.g. `ffmpeg -f rawvideo -pixel_format rgba -video_size 1280x720 -framerate 60 -i video.rgba video.mp4`.
+    RawRGBA,
+};
+
+namespace internal {
+
+/// Exports the frames of the main canvas to disk without slowing down the rendering.
+/// The pixels are read back asynchronously through a ring of pixel buffer objects, and then converted, encoded and written by a pool of worker threads.
+class Recorder {
+public:
+    /// For image sequences, `path` is the folder the images will be written into. Otherwise, it is the path of the video file.
+    Recorder(std::filesystem::path const& path, float framerate, RecordingFormat format);
+    /// Waits until all the frames have been written.
+    ~Recorder();
+    Recorder(Recorder const&)            = delete;
+    Recorder& operator=(Recorder const&) = delete;
+    Recorder(Recorder&&)                 = delete;
+    Recorder& operator=(Recorder&&)      = delete;
+
+    /// Must be called once per frame, once everything has been drawn on the canvas.
+    void capture(Canvas const& canvas);
+
+    /// Number of frames that have been captured so far.
+    uint64_t frames_count() const { return _frames_count; }
+
+private:
+    /// Reads back the oldest frame in flight, and sends it to the encoders.
+    void send_to_encoders(PixelReadback& readback);
+    void encode(std::vector<uint8_t> const& pixels, ImageSize size, uint64_t frame_index);
+    void write_in_order(std::vector<uint8_t> const& data, uint64_t frame_index);
+    std::filesystem::path image_path(uint64_t frame_index) const;
+
+private:
+    static constexpr size_t frames_in_flight = 3; // Gives the GPU enough time to render the frame and copy its pixels before we read them
+
+    std::filesystem::path _path;
+    float                 _framerate;
+    RecordingFormat       _format;
+
+    std::array<PixelReadback, frames_in_flight> _readbacks{};
+    size_t                                      _next_readback{0};
+    uint64_t                                    _frames_count{0};
+    uint64_t                                    _frames_sent_to_encoders{0};
+    std::optional<ImageSize>                    _video_size{}; // A video must have the same size for all of its frames
+
+    std::ofstream           _video_file{};
+    uint64_t                _next_frame_to_write{0}; // Frames are encoded in parallel, but must be written to the video file in order
+    std::mutex              _video_file_mutex{};
+    std::condition_variable _video_file_is_available{};
+
+    ThreadPool _encoders; // Must be destroyed first, because its threads use all the other members
+};
+
+} // namespace internal
+} // namespace p6
@@ -0,0 +1,220 @@
+#include "RectBatchRenderer.h"
+#include <array>
+#include <cstddef>
+
+namespace p6::internal {
+
+// Flushing regularly keeps the instance buffer at a reasonable size, even if someone draws millions of shapes in a single frame.
+static constexpr size_t max_instances_per_batch = 65536;
+
+RectBatchRenderer::RectBatchRenderer()
+    : _shaders{R"(
+#version 410
+
+layout(location = 0) in vec2 _vertex_position;
+layout(location = 1) in vec2 _texture_coordinates;
+layout(location = 2) in vec3 _transform_column_0;
+layout(location = 3) in vec3 _transform_column_1;
+layout(location = 4) in vec3 _transform_column_2;
+layout(location = 5) in vec2 _instance_size;
+layout(location = 6) in vec4 _instance_fill_color;
+layout(location = 7) in vec4 _instance_stroke_color;
+layout(location = 8) in vec3 _instance_style; // stroke_weight, is_ellipse, use_stroke
+
+out vec2 _canvas_uv;
+flat out vec2 _size;
+flat out vec4 _fill_color;
+flat out vec4 _stroke_color;
+flat out float _stroke_weight;
+flat out int _is_ellipse;
+
+void main()
+{
+    mat3 transform = mat3(_transform_column_0, _transform_column_1, _transform_column_2);
+    vec3 pos3 = transform * vec3(_vertex_position, 1.);
+    vec2 pos = pos3.xy / pos3.z;
+    pos.x *= _canvas_inverse_aspect_ratio;
+    gl_Position = vec4(pos, 0., 1.);
+    _canvas_uv = (_texture_coordinates - 0.5) * _instance_size * 2.;
+    _size = _instance_size;
+    _fill_color = _instance_fill_color;
+    _stroke_color = _instance_stroke_color;
+    _stroke_weight = _instance_style.x;
+    _is_ellipse = _instance_style.y > 0.5 ? 1 : 0;
+}
+    )",
+               R"(
+#version 410
+
+// Each batch is rendered with a variant of this shader that only contains the features used by the shapes of the batch:
+// P6_HAS_ELLIPSES, P6_HAS_RECTANGLES and P6_USE_STROKE
+
+in vec2 _canvas_uv;
+flat in vec2 _size;
+flat in vec4 _fill_color;
+flat in vec4 _stroke_color;
+flat in float _stroke_weight;
+flat in int _is_ellipse;
+out vec4 _frag_color;
+
+#ifdef P6_HAS_ELLIPSES
+// Thanks to https://iquilezles.org/www/articles/ellipsedist/ellipsedist.htm
+float sdEllipse(  vec2 p,  vec2 ab ) {
+    p = abs( p );
+    bool s = dot(p/ab,p/ab)>1.0;
+    float w = s ? atan(p.y*ab.x, p.x*ab.y) :
+                  ((ab.x*(p.x-ab.x)<ab.y*(p.y-ab.y))? 1.5707963 : 0.0);
+    // find root with Newton solver
+    for( int i=0; i<5; i++ ) {
+        vec2 cs = vec2(cos(w),sin(w));
+        vec2 u = ab*vec2( cs.x,cs.y);
+        vec2 v = ab*vec2(-cs.y,cs.x);
+        w = w + dot(p-u,v)/(dot(p-u,u)+dot(v,v));
+    }
+    return length(p-ab*vec2(cos(w),sin(w))) * (s?1.0:-1.0);
+}
+#endif
+
+float rect_distance() {
+    vec2 dd = _size - abs(_canvas_uv);
+    return min(dd.x, dd.y);
+}
+
+void main() {
+    const float m = 0.0005;
+
+#if defined(P6_HAS_ELLIPSES) && defined(P6_HAS_RECTANGLES)
+    float dist = _is_ellipse != 0 ? -sdEllipse(_canvas_uv, _size)
+                                  : rect_distance();
+    float shape_factor = _is_ellipse != 0 ? smoothstep(-m, m, dist)
+                                          : 1.;
+#elif defined(P6_HAS_ELLIPSES)
+    float dist = -sdEllipse(_canvas_uv, _size);
+    float shape_factor = smoothstep(-m, m, dist);
+#else
+    float dist = rect_distance();
+    float shape_factor = 1.;
+#endif
+
+    // Fill vs Stroke
+#ifdef P6_USE_STROKE
+    float t = smoothstep(-m, m, _stroke_weight - dist);
+    _frag_color = mix(_fill_color, _stroke_color, t); // Shapes that don't use stroke have their stroke color set to their fill color
+#else
+    _frag_color = _fill_color;
+#endif
+
+    _frag_color *= shape_factor;
+}
+    )",
+               InactiveUniformsDontNeedToBeSet{}}
+{
+    // VAO
+    glBindVertexArray(_vao.id());
+    // VBO
+    const std::array<float, 16> vertices = {
+        -1.f, -1.f, 0.f, 0.f,
+        -1.f, +1.f, 0.f, 1.f,
+        +1.f, +1.f, 1.f, 1.f,
+        +1.f, -1.f, 1.f, 0.f};
+    const auto vertices_size_in_bytes = vertices.size() * sizeof(float);
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo.id());
+    glBufferData(GL_ARRAY_BUFFER, vertices_size_in_bytes, nullptr, GL_STATIC_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, vertices_size_in_bytes, vertices.data());
+    const auto stride = 4 * sizeof(float);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, nullptr);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(2 * sizeof(float))); // NOLINT
+    // Instances (their buffer is only known when we flush, see set_instance_attributes())
+    for (GLuint location = 2; location <= 8; ++location)
+    {
+        glEnableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 1);
+    }
+    // IBO
+    const std::array<GLuint, 6> indices = {
+        0, 1, 2,
+        0, 2, 3};
+    const auto indices_size_in_bytes = indices.size() * sizeof(GLuint);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ibo.id());
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices_size_in_bytes, nullptr, GL_STATIC_DRAW);
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indices_size_in_bytes, indices.data());
+
+    _instances.reserve(1024);
+}
+
+/// Points the per-instance attributes of the currently bound vertex array to the instances that have been streamed at `allocation`.
+static void set_instance_attributes(StreamingBuffer::Allocation const& allocation)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, allocation.buffer);
+    const auto instance_attribute = [&](GLuint location, GLint components_count, size_t offset) {
+        glVertexAttribPointer(location, components_count, GL_FLOAT, GL_FALSE, sizeof(RectInstance), reinterpret_cast<void*>(static_cast<size_t>(allocation.offset) + offset)); // NOLINT
+    };
+    instance_attribute(2, 3, offsetof(RectInstance, transform) + 0 * sizeof(glm::vec3));
+    instance_attribute(3, 3, offsetof(RectInstance, transform) + 1 * sizeof(glm::vec3));
+    instance_attribute(4, 3, offsetof(RectInstance, transform) + 2 * sizeof(glm::vec3));
+    instance_attribute(5, 2, offsetof(RectInstance, size));
+    instance_attribute(6, 4, offsetof(RectInstance, fill_color));
+    instance_attribute(7, 4, offsetof(RectInstance, stroke_color));
+    instance_attribute(8, 3, offsetof(RectInstance, stroke_weight)); // Also reads is_ellipse and use_stroke, which are laid out right after
+}
+
+void RectBatchRenderer::push(RectInstance const& instance, OpenGLStateTracker& opengl_state, StreamingBuffer& streaming_buffer)
+{
+    _instances.push_back(instance);
+    const bool is_ellipse = instance.is_ellipse > 0.5f;
+    const bool use_stroke = instance.use_stroke > 0.5f;
+    _has_ellipses |= is_ellipse;
+    _has_rectangles |= !is_ellipse;
+    _uses_stroke |= use_stroke;
+    if (!use_stroke) // This lets the shader handle shapes with and without stroke in the same way, without branching
+        _instances.back().stroke_color = instance.fill_color;
+    if (_instances.size() >= max_instances_per_batch)
+        flush(opengl_state, streaming_buffer);
+}
+
+void RectBatchRenderer::flush(OpenGLStateTracker& opengl_state, StreamingBuffer& streaming_buffer)
+{
+    if (is_empty())
+        return;
+    opengl_state.apply(opengl_state_for_p6_rendering());
+
+    // Upload the instances
+    const auto allocation = streaming_buffer.upload(_instances.data(), _instances.size() * sizeof(RectInstance), alignof(RectInstance));
+
+    // Render
+    auto const& shader = current_shader();
+    shader.use();
+    shader.check_for_errors_before_rendering();
+    glBindVertexArray(_vao.id());
+    set_instance_attributes(allocation);
+    glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(_instances.size()));
+
+    _instances.clear();
+    _has_ellipses   = false;
+    _has_rectangles = false;
+    _uses_stroke    = false;
+}
+
+Shader const& RectBatchRenderer::current_shader() const
+{
+    const auto variant_index = (_has_ellipses ? 1u : 0u)
+                               | (_has_rectangles ? 2u : 0u)
+                               | (_uses_stroke ? 4u : 0u);
+    auto& variant = _variants[variant_index];
+    if (!variant)
+    {
+        auto defines = std::vector<std::string>{};
+        if (_has_ellipses)
+            defines.emplace_back("P6_HAS_ELLIPSES");
+        if (_has_rectangles)
+            defines.emplace_back("P6_HAS_RECTANGLES");
+        if (_uses_stroke)
+            defines.emplace_back("P6_USE_STROKE");
+        variant = &_shaders.get(std::move(defines));
+    }
+    return *variant;
+}
+
+} // namespace p6::internal
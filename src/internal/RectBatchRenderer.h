@@ -0,0 +1,56 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <array>
+#include <glpp/glpp.hpp>
+#include <vector>
+#include "../Shader.h"
+#include "OpenGLStateTracker.h"
+#include "StreamingBuffer.h"
+
+namespace p6::internal {
+
+/// All the information needed to render one rectangle or ellipse with the default p6 look.
+/// This is uploaded as-is into the instance buffer, so it must stay a tightly-packed POD.
+struct RectInstance {
+    glm::mat3 transform;
+    glm::vec2 size;
+    glm::vec4 fill_color;
+    glm::vec4 stroke_color;
+    float     stroke_weight;
+    float     is_ellipse;
+    float     use_stroke;
+};
+
+/// Collects rectangles and ellipses and renders them all at once with a single instanced draw call.
+/// The shapes are rendered in the order they have been pushed.
+class RectBatchRenderer {
+public:
+    RectBatchRenderer();
+
+    /// Adds a shape to the current batch.
+    /// The batch must be flushed before anything that affects its rendering changes (canvas, frame data, etc.).
+    void push(RectInstance const& instance, OpenGLStateTracker& opengl_state, StreamingBuffer& streaming_buffer);
+    /// Renders all the shapes that have been pushed since the last flush, and empties the batch.
+    void flush(OpenGLStateTracker& opengl_state, StreamingBuffer& streaming_buffer);
+
+    bool is_empty() const { return _instances.empty(); }
+
+private:
+    Shader const& current_shader() const;
+
+private:
+    std::vector<RectInstance> _instances{};
+    // Which features the shapes of the current batch use, so that we can render them with the simplest variant of the shader
+    bool _has_ellipses{false};
+    bool _has_rectangles{false};
+    bool _uses_stroke{false};
+
+    glpp::UniqueVertexArray _vao;
+    glpp::UniqueBuffer      _vbo;
+    glpp::UniqueBuffer      _ibo;
+
+    ShaderVariantSet                     _shaders;
+    mutable std::array<Shader const*, 8> _variants{}; // Indexed by the combination of features, so that we don't need to build the list of defines at each flush
+};
+
+} // namespace p6::internal
@@ -1,6 +1,5 @@
 #include "RectRenderer.h"
 #include <array>
-#include "OpenglStateRAII.h"
 
 namespace p6::internal {
 
@@ -33,9 +32,9 @@ RectRenderer::RectRenderer()
     glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indices_size_in_bytes, indices.data());
 }
 
-void RectRenderer::render() const
+void RectRenderer::render(OpenGLStateTracker& opengl_state) const
 {
-    auto raii = OpenGLStateRAII{};
+    opengl_state.apply(opengl_state_for_p6_rendering());
     glBindVertexArray(_vao.id());
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
 }
@@ -1,12 +1,13 @@
 #pragma once
 #include <glpp/glpp.hpp>
+#include "OpenGLStateTracker.h"
 
 namespace p6::internal {
 
 class RectRenderer {
 public:
     RectRenderer();
-    void render() const;
+    void render(OpenGLStateTracker& opengl_state) const;
 
 private:
     glpp::UniqueVertexArray _vao;
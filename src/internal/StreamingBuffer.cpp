@@ -0,0 +1,172 @@
+#include "StreamingBuffer.h"
+#include <algorithm>
+#include <cstring>
+#include "glfw.h"
+
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+namespace p6::internal {
+
+static constexpr size_t initial_section_size = 1024 * 1024; // 1 MB per frame is enough for a few tens of thousands of shapes, and the buffer grows if needed
+
+// We query the function through GLFW because our OpenGL loader isn't necessarily generated with OpenGL 4.4 (and macOS only has 4.1)
+using BufferStorage = void(APIENTRY*)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+
+static auto buffer_storage_function() -> BufferStorage
+{
+    static const auto function = []() -> BufferStorage {
+        auto const* name = glfwExtensionSupported("GL_ARB_buffer_storage") ? "glBufferStorage"
+                           : glfwExtensionSupported("GL_EXT_buffer_storage") ? "glBufferStorageEXT"
+                                                                             : nullptr;
+        if (!name)
+            return nullptr;
+        return reinterpret_cast<BufferStorage>(glfwGetProcAddress(name)); // NOLINT
+    }();
+    return function;
+}
+
+static auto align(size_t offset, size_t alignment) -> size_t
+{
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+StreamingBuffer::StreamingBuffer()
+{
+    create_buffer(frames_in_flight * initial_section_size);
+}
+
+StreamingBuffer::~StreamingBuffer()
+{
+    destroy_buffer();
+}
+
+void StreamingBuffer::create_buffer(size_t size_in_bytes)
+{
+    glGenBuffers(1, &_buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _buffer);
+    _buffer_size = size_in_bytes;
+
+    const auto buffer_storage = buffer_storage_function();
+    if (buffer_storage)
+    {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        buffer_storage(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(_buffer_size), nullptr, flags);
+        _mapped_memory = static_cast<std::byte*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, static_cast<GLsizeiptr>(_buffer_size), flags));
+    }
+    _is_persistently_mapped = _mapped_memory != nullptr;
+    if (!_is_persistently_mapped)
+        glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(_buffer_size), nullptr, GL_STREAM_DRAW);
+
+    _section_index                = 0;
+    _offset                       = 0;
+    _current_section_is_available = true; // The buffer is brand new, the GPU isn't using it
+}
+
+void StreamingBuffer::destroy_buffer()
+{
+    for (auto& fence : _fences)
+    {
+        if (fence)
+            glDeleteSync(fence);
+        fence = nullptr;
+    }
+    if (_mapped_memory)
+    {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, _buffer);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        _mapped_memory = nullptr;
+    }
+    glDeleteBuffers(1, &_buffer); // The driver keeps the storage alive until the draw calls that use it are done
+    _buffer = 0;
+}
+
+void StreamingBuffer::wait_until_current_section_is_available()
+{
+    if (_current_section_is_available)
+        return;
+    auto& fence = _fences[_section_index];
+    if (fence)
+    {
+        // The section was last used frames_in_flight frames ago, so in practice the GPU is almost always done with it and this doesn't block
+        while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000'000) == GL_TIMEOUT_EXPIRED) {}
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+    _current_section_is_available = true;
+}
+
+auto StreamingBuffer::upload(void const* data, size_t size_in_bytes, size_t alignment) -> Allocation
+{
+    _bytes_streamed_this_frame += size_in_bytes;
+
+    if (_is_persistently_mapped)
+    {
+        const auto section_size = _buffer_size / frames_in_flight;
+        auto       offset       = align(_offset, alignment);
+        if (offset + size_in_bytes > section_size)
+        {
+            // Grow so that a whole frame fits in one section. The old buffer is kept alive by the driver as long as the GPU uses it.
+            destroy_buffer();
+            create_buffer(frames_in_flight * std::max(2 * section_size, align(size_in_bytes, alignment)));
+            offset = 0;
+        }
+        wait_until_current_section_is_available();
+        const auto absolute_offset = _section_index * (_buffer_size / frames_in_flight) + offset;
+        std::memcpy(_mapped_memory + absolute_offset, data, size_in_bytes); // NOLINT(*-pointer-arithmetic)
+        _offset = offset + size_in_bytes;
+        return {_buffer, static_cast<GLintptr>(absolute_offset)};
+    }
+
+    auto offset = align(_offset, alignment);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _buffer);
+    if (offset + size_in_bytes > _buffer_size)
+    {
+        if (size_in_bytes > _buffer_size)
+        {
+            destroy_buffer();
+            create_buffer(std::max(2 * _buffer_size, align(size_in_bytes, alignment)));
+        }
+        else
+        {
+            glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(_buffer_size), nullptr, GL_STREAM_DRAW); // Orphan the previous storage so that we don't have to wait for the GPU to be done with it
+        }
+        offset = 0;
+    }
+    // We never write twice to the same range of a given storage, so there is no need for the driver to synchronize with the GPU
+    auto* memory = glMapBufferRange(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size_in_bytes), GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+    std::memcpy(memory, data, size_in_bytes);
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    _offset = offset + size_in_bytes;
+    return {_buffer, static_cast<GLintptr>(offset)};
+}
+
+void StreamingBuffer::end_frame()
+{
+    _bytes_streamed_last_frame = _bytes_streamed_this_frame;
+    _bytes_streamed_this_frame = 0;
+    if (!_is_persistently_mapped)
+        return;
+    if (_offset == 0) // Nothing has been written in this section, no need to protect it
+        return;
+
+    auto& fence = _fences[_section_index];
+    if (fence)
+        glDeleteSync(fence);
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    _section_index                = (_section_index + 1) % frames_in_flight;
+    _offset                       = 0;
+    _current_section_is_available = false;
+}
+
+StreamingStats StreamingBuffer::stats() const
+{
+    return {_bytes_streamed_last_frame, _buffer_size, _is_persistently_mapped};
+}
+
+} // namespace p6::internal
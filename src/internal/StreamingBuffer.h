@@ -0,0 +1,67 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <glpp/glpp.hpp>
+
+namespace p6 {
+
+struct StreamingStats {
+    /// Number of bytes of geometry that have been sent to the GPU during the last frame.
+    size_t bytes_streamed_last_frame{0};
+    /// Size of the GPU buffer that the geometry is streamed into. It grows automatically when a frame needs more.
+    size_t buffer_size{0};
+    /// Whether the buffer is persistently mapped (needs OpenGL 4.4 or GL_ARB_buffer_storage), or falls back to orphaning.
+    bool is_persistently_mapped{false};
+};
+
+namespace internal {
+
+/// A ring buffer that all renderers write the geometry they generate each frame into, so that sending it to the GPU never has to wait for the GPU to be done with the previous frames.
+/// When glBufferStorage is available the buffer is mapped once and for all, split in one section per frame in flight, and fences tell us when a section can be written again.
+/// Otherwise we append to the buffer without synchronization, and orphan it whenever it is full.
+class StreamingBuffer {
+public:
+    struct Allocation {
+        GLuint   buffer;
+        GLintptr offset;
+    };
+
+    StreamingBuffer();
+    ~StreamingBuffer();
+    StreamingBuffer(StreamingBuffer const&)            = delete;
+    StreamingBuffer& operator=(StreamingBuffer const&) = delete;
+    StreamingBuffer(StreamingBuffer&&)                 = delete;
+    StreamingBuffer& operator=(StreamingBuffer&&)      = delete;
+
+    /// Copies the data into the buffer. The returned allocation stays valid until the end of the frame.
+    /// :warning: The buffer might change from one allocation to the next, so the vertex attributes must be set again each time.
+    Allocation upload(void const* data, size_t size_in_bytes, size_t alignment);
+    /// Must be called once per frame, after all the draw calls of the frame have been issued.
+    void end_frame();
+
+    StreamingStats stats() const;
+
+private:
+    void create_buffer(size_t size_in_bytes);
+    void destroy_buffer();
+    void wait_until_current_section_is_available();
+
+private:
+    static constexpr size_t frames_in_flight = 3;
+
+    GLuint     _buffer{0};
+    size_t     _buffer_size{0};
+    std::byte* _mapped_memory{nullptr}; // Only used when persistently mapped
+    bool       _is_persistently_mapped{false};
+
+    size_t                               _section_index{0};
+    size_t                               _offset{0}; // Relative to the start of the current section when persistently mapped, to the start of the buffer otherwise
+    bool                                 _current_section_is_available{false};
+    std::array<GLsync, frames_in_flight> _fences{};
+
+    size_t _bytes_streamed_this_frame{0};
+    size_t _bytes_streamed_last_frame{0};
+};
+
+} // namespace internal
+} // namespace p6
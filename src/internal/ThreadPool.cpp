@@ -0,0 +1,99 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <exception>
+#include <iostream>
+
+namespace p6::internal {
+
+ThreadPool::ThreadPool(size_t threads_count, size_t max_pending_tasks)
+    : _max_pending_tasks{std::max<size_t>(max_pending_tasks, 1)}
+{
+    threads_count = std::max<size_t>(threads_count, 1);
+    _threads.reserve(threads_count);
+    for (size_t i = 0; i < threads_count; ++i)
+        _threads.emplace_back([this]() { work(); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lock{_mutex};
+        _is_shutting_down = true;
+    }
+    _task_available.notify_all();
+    for (auto& thread : _threads)
+        thread.join();
+}
+
+void ThreadPool::push(std::function<void()> task)
+{
+    {
+        std::unique_lock lock{_mutex};
+        _task_done.wait(lock, [&]() { return _tasks.size() < _max_pending_tasks; });
+        _tasks.push_back(std::move(task));
+    }
+    _task_available.notify_one();
+}
+
+bool ThreadPool::try_push(std::function<void()> task)
+{
+    {
+        std::lock_guard lock{_mutex};
+        if (_tasks.size() >= _max_pending_tasks)
+            return false;
+        _tasks.push_back(std::move(task));
+    }
+    _task_available.notify_one();
+    return true;
+}
+
+void ThreadPool::wait_until_idle()
+{
+    std::unique_lock lock{_mutex};
+    _task_done.wait(lock, [&]() { return _tasks.empty() && _running_tasks_count == 0; });
+}
+
+size_t ThreadPool::pending_tasks_count() const
+{
+    std::lock_guard lock{_mutex};
+    return _tasks.size() + _running_tasks_count;
+}
+
+size_t ThreadPool::default_threads_count()
+{
+    const auto cores_count = static_cast<size_t>(std::thread::hardware_concurrency()); // Can be 0 if it is unknown
+    return cores_count > 1 ? cores_count - 1 : 1;
+}
+
+void ThreadPool::work()
+{
+    while (true)
+    {
+        auto task = std::function<void()>{};
+        {
+            std::unique_lock lock{_mutex};
+            _task_available.wait(lock, [&]() { return _is_shutting_down || !_tasks.empty(); });
+            if (_tasks.empty()) // We only stop once all the tasks are done
+                return;
+            task = std::move(_tasks.front());
+            _tasks.pop_front();
+            _running_tasks_count++;
+        }
+        _task_done.notify_all(); // Some room has been made in the queue
+        try
+        {
+            task();
+        }
+        catch (std::exception const& e)
+        {
+            std::cerr << "[p6::ThreadPool] A task has thrown an exception: " << e.what() << '\n';
+        }
+        {
+            std::lock_guard lock{_mutex};
+            _running_tasks_count--;
+        }
+        _task_done.notify_all();
+    }
+}
+
+} // namespace p6::internal
@@ -0,0 +1,52 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace p6::internal {
+
+/// Runs tasks on a fixed number of worker threads, in the order they have been pushed.
+/// The queue is bounded: pushing blocks while it is full, so that a producer that is faster than the workers can't accumulate an unbounded amount of work (and memory).
+class ThreadPool {
+public:
+    /// `threads_count` is clamped to at least 1.
+    ThreadPool(size_t threads_count, size_t max_pending_tasks);
+    /// Finishes all the pending tasks before returning.
+    ~ThreadPool();
+    ThreadPool(ThreadPool const&)            = delete;
+    ThreadPool& operator=(ThreadPool const&) = delete;
+    ThreadPool(ThreadPool&&)                 = delete;
+    ThreadPool& operator=(ThreadPool&&)      = delete;
+
+    /// Blocks while the queue is full.
+    void push(std::function<void()> task);
+    /// Returns false instead of blocking if the queue is full.
+    bool try_push(std::function<void()> task);
+    /// Blocks until all the tasks that have been pushed are done.
+    void wait_until_idle();
+
+    /// Number of tasks that have been pushed and are not done yet.
+    size_t pending_tasks_count() const;
+
+    /// A good default number of workers for CPU-heavy tasks: leaves one core for the render thread.
+    static size_t default_threads_count();
+
+private:
+    void work();
+
+private:
+    std::vector<std::thread>          _threads{};
+    std::deque<std::function<void()>> _tasks{};
+    size_t                            _max_pending_tasks;
+    size_t                            _running_tasks_count{0};
+    bool                              _is_shutting_down{false};
+    mutable std::mutex                _mutex{};
+    std::condition_variable           _task_available{};
+    std::condition_variable           _task_done{};
+};
+
+} // namespace p6::internal
@@ -0,0 +1,170 @@
+#include "FramePacer.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include "../glfw.h"
+
+namespace p6::internal {
+
+// After an event we render a few frames, because ImGui needs one more frame to react to some inputs (e.g. hovering a widget that has just appeared)
+static constexpr int frames_to_render_after_an_event = 2;
+
+// We never rely on the OS to wake us up more precisely than this
+static constexpr auto min_wake_up_margin = std::chrono::microseconds{250};
+static constexpr auto max_wake_up_margin = std::chrono::milliseconds{20}; // Some OSes have a timer resolution as coarse as 15.6ms
+
+void FramePacer::set_target_frame_duration(std::optional<std::chrono::nanoseconds> duration)
+{
+    _target_frame_duration = duration;
+    _next_frame_time       = clock::now();
+}
+
+void FramePacer::set_render_on_demand(bool enabled)
+{
+    _render_on_demand      = enabled;
+    _frames_left_to_render = frames_to_render_after_an_event;
+    _next_scheduled_frame.reset();
+}
+
+void FramePacer::request_frame()
+{
+    _frame_has_been_requested.store(true);
+    glfwPostEmptyEvent(); // Wakes up glfwWaitEvents()
+}
+
+void FramePacer::request_frame_at(clock::time_point time)
+{
+    if (!_next_scheduled_frame || time < *_next_scheduled_frame)
+        _next_scheduled_frame = time;
+}
+
+bool FramePacer::is_time_for_next_frame() const
+{
+    return !_target_frame_duration
+           || clock::now() >= _next_frame_time;
+}
+
+void FramePacer::frame_has_started()
+{
+    const auto now = clock::now();
+
+    _latenesses[_history_index]      = _target_frame_duration ? std::max(now - _next_frame_time, clock::duration::zero()) : clock::duration::zero();
+    _frame_durations[_history_index] = _last_frame_start ? now - *_last_frame_start : clock::duration::zero();
+    _last_frame_start                = now;
+    _history_index                   = (_history_index + 1) % history_size;
+    _history_count                   = std::min(_history_count + 1, history_size);
+
+    if (!_target_frame_duration)
+        return;
+    // Schedule relatively to when this frame should have started, and not to when it actually started, so that small delays don't accumulate into a lower framerate
+    _next_frame_time += *_target_frame_duration;
+    if (_next_frame_time < now) // We are more than a frame late (e.g. the window was being dragged), don't try to catch up with a burst of frames
+        _next_frame_time = now + *_target_frame_duration;
+}
+
+void FramePacer::wait_for_next_frame_on_demand()
+{
+    if (_frame_has_been_requested.exchange(false))
+        _frames_left_to_render = std::max(_frames_left_to_render, 1);
+    if (_frames_left_to_render > 0)
+    {
+        --_frames_left_to_render;
+        glfwPollEvents();
+        return;
+    }
+
+    // Whatever wakes us up (an input, a resize, a requested or scheduled frame) means that we need to render
+    auto is_scheduled_frame = false;
+    if (_next_scheduled_frame)
+    {
+        const auto remaining = *_next_scheduled_frame - clock::now();
+        if (remaining > clock::duration::zero())
+            glfwWaitEventsTimeout(std::chrono::duration<double>{remaining}.count());
+        else
+            glfwPollEvents();
+        if (clock::now() >= *_next_scheduled_frame)
+        {
+            _next_scheduled_frame.reset();
+            is_scheduled_frame = true;
+        }
+    }
+    else
+    {
+        glfwWaitEvents();
+    }
+    // A request_frame() that raced with our wake up might have posted its empty event after the events were processed.
+    // Drain it now, otherwise it would wake us up again once this frame is done, and we would render for nothing.
+    glfwPollEvents();
+    const auto was_requested = _frame_has_been_requested.exchange(false);
+    // Requested and scheduled frames only need to be rendered once. Inputs need a few frames so that ImGui can react to them.
+    _frames_left_to_render = (was_requested || is_scheduled_frame) ? 0
+                                                                   : frames_to_render_after_an_event - 1; // The frame that is about to start is the first one
+}
+
+void FramePacer::wait_for_next_frame(GLFWwindow* window)
+{
+    if (_render_on_demand)
+    {
+        wait_for_next_frame_on_demand();
+        return;
+    }
+    if (!_target_frame_duration)
+    {
+        glfwPollEvents();
+        return;
+    }
+
+    // Sleep while processing events
+    while (true)
+    {
+        const auto remaining = _next_frame_time - clock::now();
+        if (remaining <= _wake_up_margin)
+            break;
+        const auto requested_wake_up = clock::now() + (remaining - _wake_up_margin);
+        glfwWaitEventsTimeout(std::chrono::duration<double>{remaining - _wake_up_margin}.count());
+        if (glfwWindowShouldClose(window))
+            return;
+        const auto oversleep = clock::now() - requested_wake_up;
+        if (oversleep > clock::duration::zero()) // Otherwise we have been woken up early by an event, which doesn't tell us anything about the precision of the timer
+        {
+            // Move the margin towards the observed oversleep, with some headroom. It grows fast and shrinks slowly, because waking up too late is worse than spinning a bit longer.
+            const auto target = std::clamp(std::chrono::duration_cast<std::chrono::nanoseconds>(oversleep * 5 / 4), std::chrono::nanoseconds{min_wake_up_margin}, std::chrono::nanoseconds{max_wake_up_margin});
+            _wake_up_margin   = target > _wake_up_margin ? target : (_wake_up_margin * 15 + target) / 16;
+        }
+    }
+
+    // Spin for the last fraction of a millisecond
+    while (clock::now() < _next_frame_time)
+        std::this_thread::yield();
+    glfwPollEvents();
+}
+
+FramePacingStats FramePacer::stats() const
+{
+    auto stats = FramePacingStats{};
+    if (_history_count < 2)
+        return stats;
+
+    // The first recorded frame has no previous frame to compute a duration from
+    const auto durations_count = _history_count == history_size ? history_size : _history_count - 1;
+    const auto first_duration  = _history_count == history_size ? 0 : 1;
+
+    double sum{0.};
+    for (size_t i = first_duration; i < first_duration + durations_count; ++i)
+        sum += static_cast<double>(_frame_durations[i].count());
+    const double average = sum / static_cast<double>(durations_count);
+
+    double squared_deviations_sum{0.};
+    for (size_t i = first_duration; i < first_duration + durations_count; ++i)
+    {
+        const double deviation = static_cast<double>(_frame_durations[i].count()) - average;
+        squared_deviations_sum += deviation * deviation;
+    }
+
+    stats.average_frame_duration = std::chrono::nanoseconds{static_cast<std::chrono::nanoseconds::rep>(average)};
+    stats.jitter                 = std::chrono::nanoseconds{static_cast<std::chrono::nanoseconds::rep>(std::sqrt(squared_deviations_sum / static_cast<double>(durations_count)))};
+    stats.max_lateness           = *std::max_element(_latenesses.begin(), _latenesses.begin() + static_cast<std::ptrdiff_t>(_history_count));
+    return stats;
+}
+
+} // namespace p6::internal
@@ -0,0 +1,71 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+
+struct GLFWwindow;
+
+namespace p6 {
+
+struct FramePacingStats {
+    /// Average time between the start of two consecutive frames, over the last few seconds.
+    std::chrono::nanoseconds average_frame_duration{0};
+    /// Standard deviation of the time between the start of two consecutive frames, over the last few seconds. The lower, the smoother the animation.
+    std::chrono::nanoseconds jitter{0};
+    /// The biggest delay between the moment a frame should have started and the moment it actually started, over the last few seconds.
+    std::chrono::nanoseconds max_lateness{0};
+};
+
+namespace internal {
+
+/// Makes frames start at a regular interval, without using the CPU while waiting for the next one:
+/// we wait for window events with a timeout, and only spin during the last fraction of a millisecond, which the OS timers are not precise enough for.
+class FramePacer {
+public:
+    using clock = std::chrono::steady_clock;
+
+    /// std::nullopt means that frames are not limited.
+    void set_target_frame_duration(std::optional<std::chrono::nanoseconds> duration);
+    bool is_capped() const { return _target_frame_duration.has_value(); }
+
+    /// When enabled, we sleep until there is a window event or until a frame is requested.
+    void set_render_on_demand(bool enabled);
+    /// Wakes up the loop in render on demand mode. Can be called from any thread.
+    void request_frame();
+    /// Schedules a frame in render on demand mode. Must be called on the main thread.
+    void request_frame_at(clock::time_point time);
+
+    /// Returns true iff the next frame can start now.
+    bool is_time_for_next_frame() const;
+    /// Must be called whenever a frame starts, to schedule the next one.
+    void frame_has_started();
+    /// Processes the window events, and blocks until it is time for the next frame (or until the window is asked to close).
+    void wait_for_next_frame(GLFWwindow* window);
+
+    FramePacingStats stats() const;
+
+private:
+    void wait_for_next_frame_on_demand();
+
+private:
+    std::optional<std::chrono::nanoseconds> _target_frame_duration{};
+    clock::time_point                       _next_frame_time{clock::now()};
+    std::chrono::nanoseconds                _wake_up_margin{std::chrono::milliseconds{1}}; // How early we ask the OS to wake us up, learned from how late it actually wakes us up
+
+    bool                             _render_on_demand{false};
+    std::atomic<bool>                _frame_has_been_requested{false};
+    std::optional<clock::time_point> _next_scheduled_frame{};
+    int                              _frames_left_to_render{0};
+
+    static constexpr size_t                            history_size = 256;
+    std::array<std::chrono::nanoseconds, history_size> _frame_durations{};
+    std::array<std::chrono::nanoseconds, history_size> _latenesses{};
+    size_t                                             _history_count{0};
+    size_t                                             _history_index{0};
+    std::optional<clock::time_point>                   _last_frame_start{};
+};
+
+} // namespace internal
+} // namespace p6
@@ -0,0 +1,122 @@
+#include "TriangleBatchRenderer.h"
+#include <cmath>
+#include <cstddef>
+
+namespace p6::internal {
+
+// Flushing regularly keeps the vertex buffer at a reasonable size, even if someone draws millions of triangles in a single frame.
+static constexpr size_t max_triangles_per_batch = 65536;
+
+TriangleBatchRenderer::TriangleBatchRenderer()
+    : _shader{R"(
+#version 410
+
+layout(location = 0) in vec2 _vertex_position;
+layout(location = 1) in vec3 _vertex_edges_heights;
+layout(location = 2) in vec4 _vertex_fill_color;
+layout(location = 3) in vec4 _vertex_stroke_color;
+layout(location = 4) in float _vertex_stroke_weight;
+
+noperspective out vec3 _distance_to_edges;
+flat out vec4 _fill_color;
+flat out vec4 _stroke_color;
+flat out float _stroke_weight;
+
+void main()
+{
+    gl_Position = vec4(_vertex_position * vec2(_canvas_inverse_aspect_ratio, 1.), 0., 1.);
+    // Each vertex is at a distance 0 of the two edges it belongs to, and at a distance "height" of the opposite one
+    vec3 barycentric_coordinates = vec3(0.);
+    barycentric_coordinates[gl_VertexID % 3] = 1.;
+    _distance_to_edges = barycentric_coordinates * _vertex_edges_heights;
+    _fill_color = _vertex_fill_color;
+    _stroke_color = _vertex_stroke_color;
+    _stroke_weight = _vertex_stroke_weight;
+}
+    )",
+              R"(
+#version 410
+out vec4 _frag_color;
+
+noperspective in vec3 _distance_to_edges;
+flat in vec4 _fill_color;
+flat in vec4 _stroke_color;
+flat in float _stroke_weight;
+
+void main()
+{
+    float d = min(min(_distance_to_edges.x, _distance_to_edges.y), _distance_to_edges.z);
+    _frag_color = (d < _stroke_weight)
+                    ? _stroke_color
+                    : _fill_color;
+}
+    )"}
+{
+    // The buffer of the vertices is only known when we flush, see set_vertex_attributes()
+    glBindVertexArray(_vao.id());
+    for (GLuint location = 0; location <= 4; ++location)
+        glEnableVertexAttribArray(location);
+
+    _vertices.reserve(3 * 1024);
+}
+
+/// Points the attributes of the currently bound vertex array to the vertices that have been streamed at `allocation`.
+static void set_vertex_attributes(StreamingBuffer::Allocation const& allocation)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, allocation.buffer);
+    const auto attribute = [&](GLuint location, GLint components_count, size_t offset) {
+        glVertexAttribPointer(location, components_count, GL_FLOAT, GL_FALSE, sizeof(TriangleVertex), reinterpret_cast<void*>(static_cast<size_t>(allocation.offset) + offset)); // NOLINT
+    };
+    attribute(0, 2, offsetof(TriangleVertex, position));
+    attribute(1, 3, offsetof(TriangleVertex, edges_heights));
+    attribute(2, 4, offsetof(TriangleVertex, fill_color));
+    attribute(3, 4, offsetof(TriangleVertex, stroke_color));
+    attribute(4, 1, offsetof(TriangleVertex, stroke_weight));
+}
+
+static auto distance_to_line(glm::vec2 point, glm::vec2 line_start, glm::vec2 line_end) -> float
+{
+    auto const line_length = glm::distance(line_start, line_end);
+    if (line_length == 0.f) // Degenerate triangle, it won't produce any fragment anyways
+        return 0.f;
+    auto const v1 = line_end - line_start;
+    auto const v2 = point - line_start;
+    return std::abs(v1.x * v2.y - v1.y * v2.x) / line_length;
+}
+
+void TriangleBatchRenderer::push(glm::vec2 p1, glm::vec2 p2, glm::vec2 p3,
+                                 glm::vec4 const& fill_color, glm::vec4 const& stroke_color, float stroke_weight,
+                                 OpenGLStateTracker& opengl_state, StreamingBuffer& streaming_buffer)
+{
+    auto const edges_heights = glm::vec3{
+        distance_to_line(p1, p2, p3),
+        distance_to_line(p2, p1, p3),
+        distance_to_line(p3, p1, p2),
+    };
+    _vertices.push_back({p1, edges_heights, fill_color, stroke_color, stroke_weight});
+    _vertices.push_back({p2, edges_heights, fill_color, stroke_color, stroke_weight});
+    _vertices.push_back({p3, edges_heights, fill_color, stroke_color, stroke_weight});
+    if (_vertices.size() >= 3 * max_triangles_per_batch)
+        flush(opengl_state, streaming_buffer);
+}
+
+void TriangleBatchRenderer::flush(OpenGLStateTracker& opengl_state, StreamingBuffer& streaming_buffer)
+{
+    if (is_empty())
+        return;
+    opengl_state.apply(opengl_state_for_p6_rendering());
+
+    // Upload the vertices
+    const auto allocation = streaming_buffer.upload(_vertices.data(), _vertices.size() * sizeof(TriangleVertex), alignof(TriangleVertex));
+
+    // Render
+    _shader.use();
+    _shader.check_for_errors_before_rendering();
+    glBindVertexArray(_vao.id());
+    set_vertex_attributes(allocation);
+    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(_vertices.size()));
+
+    _vertices.clear();
+}
+
+} // namespace p6::internal
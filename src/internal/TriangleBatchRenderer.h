@@ -0,0 +1,44 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <glpp/glpp.hpp>
+#include <vector>
+#include "../Shader.h"
+#include "OpenGLStateTracker.h"
+#include "StreamingBuffer.h"
+
+namespace p6::internal {
+
+/// One of the three vertices of a triangle.
+/// This is uploaded as-is into the vertex buffer, so it must stay a tightly-packed POD.
+struct TriangleVertex {
+    glm::vec2 position; // Already transformed, in the coordinates of the canvas
+    glm::vec3 edges_heights; // Distance between each vertex of the triangle and the opposite edge, used to draw the stroke
+    glm::vec4 fill_color;
+    glm::vec4 stroke_color;
+    float     stroke_weight;
+};
+
+/// Collects triangles and renders them all at once with a single draw call.
+/// The triangles are rendered in the order they have been pushed.
+class TriangleBatchRenderer {
+public:
+    TriangleBatchRenderer();
+
+    /// Adds a triangle to the current batch. The points must already be transformed.
+    /// The batch must be flushed before anything that affects its rendering changes (canvas, frame data, etc.).
+    void push(glm::vec2 p1, glm::vec2 p2, glm::vec2 p3,
+              glm::vec4 const& fill_color, glm::vec4 const& stroke_color, float stroke_weight,
+              OpenGLStateTracker& opengl_state, StreamingBuffer& streaming_buffer);
+    /// Renders all the triangles that have been pushed since the last flush, and empties the batch.
+    void flush(OpenGLStateTracker& opengl_state, StreamingBuffer& streaming_buffer);
+
+    bool is_empty() const { return _vertices.empty(); }
+
+private:
+    std::vector<TriangleVertex> _vertices{};
+    glpp::UniqueVertexArray     _vao;
+
+    Shader _shader;
+};
+
+} // namespace p6::internal
@@ -8,9 +8,10 @@ namespace p6::internal {
 
 class WindowFactory {
 public:
-    static void init()
+    /// The first window that is created decides which platform glfw is initialized with.
+    static void init(bool headless)
     {
-        static WindowFactory instance{};
+        static WindowFactory instance{headless};
     }
     WindowFactory(const WindowFactory&)            = delete;
     WindowFactory& operator=(const WindowFactory&) = delete;
@@ -18,11 +19,24 @@ public:
     WindowFactory& operator=(WindowFactory&&)      = delete;
 
 private:
-    WindowFactory()
+    explicit WindowFactory(bool headless)
     {
         glfwSetErrorCallback([](int, const char* error_message) {
             std::cerr << "[glfw error] " << error_message << '\n';
         });
+#if defined(GLFW_PLATFORM_NULL) // Available since glfw 3.4
+        if (headless)
+        {
+            glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL); // Doesn't need any display server
+            if (glfwInit())
+                return;
+            std::cerr << "[p6::WindowFactory] The null platform is not available, falling back to an invisible window\n";
+            glfwInitHint(GLFW_PLATFORM, GLFW_ANY_PLATFORM);
+        }
+#else
+        if (headless)
+            std::cerr << "[p6::WindowFactory] Running without a display server requires glfw 3.4 or later, falling back to an invisible window\n";
+#endif
         if (!glfwInit())
         {
             throw std::runtime_error("[p6::WindowFactory] Failed to initialize glfw");
@@ -35,9 +49,17 @@ private:
     }
 };
 
+static auto create_window(WindowCreationParams const& window_creation_params) -> GLFWwindow*
+{
+    return glfwCreateWindow(window_creation_params.width,
+                            window_creation_params.height,
+                            window_creation_params.title,
+                            nullptr, nullptr);
+}
+
 UniqueGlfwWindow::UniqueGlfwWindow(WindowCreationParams window_creation_params)
 {
-    WindowFactory::init();
+    WindowFactory::init(window_creation_params.headless);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
 #if !defined(__APPLE__)
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3); // OpenGL 4.3 allows us to use improved debugging. But it is not available on MacOS.
@@ -49,10 +71,23 @@ UniqueGlfwWindow::UniqueGlfwWindow(WindowCreationParams window_creation_params)
 #endif
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE); // Required on MacOS
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);           // Required on MacOS
-    _window = glfwCreateWindow(window_creation_params.width,       // NOLINT(cppcoreguidelines-prefer-member-initializer)
-                               window_creation_params.height,
-                               window_creation_params.title,
-                               nullptr, nullptr);
+    glfwWindowHint(GLFW_VISIBLE, window_creation_params.headless ? GLFW_FALSE : GLFW_TRUE);
+    if (window_creation_params.headless)
+    {
+        // Try the software implementations first, so that we don't depend on a GPU nor a display
+        for (const int context_creation_api : {GLFW_OSMESA_CONTEXT_API, GLFW_EGL_CONTEXT_API, GLFW_NATIVE_CONTEXT_API})
+        {
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, context_creation_api);
+            _window = create_window(window_creation_params);
+            if (_window)
+                break;
+        }
+    }
+    else
+    {
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_NATIVE_CONTEXT_API);
+        _window = create_window(window_creation_params); // NOLINT(cppcoreguidelines-prefer-member-initializer)
+    }
     if (!_window)
     {
         throw std::runtime_error("[p6::UniqueGlfwWindow] Failed to create a window");
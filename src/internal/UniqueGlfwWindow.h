@@ -8,6 +8,11 @@ struct WindowCreationParams {
     int         width  = 1280;
     int         height = 720;
     const char* title  = "p6";
+    /// Creates an offscreen context, without any visible window, e.g. to render on a server that has no display.
+    /// When available, p6 uses GLFW's null platform and a software OpenGL implementation (OSMesa / EGL), so this works without any GPU nor display server.
+    /// :warning: The null platform requires glfw 3.4 or later. With older versions you get an invisible window, which still needs a display server (e.g. Xvfb).
+    /// ImGui is disabled, and you can drive the frames yourself with `Context::render_frame()`.
+    bool headless = false;
     ImGuiConfigFlags imgui_config_flags = ImGuiConfigFlags_NavEnableKeyboard  // Enable Keyboard Controls
                                           | ImGuiConfigFlags_ViewportsEnable; // Enable Multi-Viewport / Platform Windows
 };
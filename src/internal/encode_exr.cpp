@@ -0,0 +1,103 @@
+#include "encode_exr.h"
+#include <array>
+#include <string>
+#include <utility>
+
+namespace p6::internal {
+
+// Everything in an OpenEXR file is little-endian. So are the half floats we get from OpenGL, on all the platforms p6 supports.
+
+static void write_bytes(std::vector<uint8_t>& out, void const* data, size_t size)
+{
+    auto const* bytes = static_cast<uint8_t const*>(data);
+    out.insert(out.end(), bytes, bytes + size); // NOLINT(*-pointer-arithmetic)
+}
+
+template<typename T>
+static void write_value(std::vector<uint8_t>& out, T value)
+{
+    write_bytes(out, &value, sizeof(T));
+}
+
+static void write_string(std::vector<uint8_t>& out, std::string const& str)
+{
+    write_bytes(out, str.c_str(), str.size() + 1); // Including the null terminator
+}
+
+static void write_attribute_header(std::vector<uint8_t>& out, std::string const& name, std::string const& type, int32_t size)
+{
+    write_string(out, name);
+    write_string(out, type);
+    write_value(out, size);
+}
+
+std::vector<uint8_t> encode_exr(uint16_t const* rgba_half_pixels, uint32_t width, uint32_t height, bool flip_vertically)
+{
+    constexpr int32_t half_pixel_type = 1;
+    // The channels must be sorted alphabetically, and each one is stored as a separate run of values inside each scanline
+    constexpr std::array<std::pair<char, size_t>, 4> channels{{{'A', 3}, {'B', 2}, {'G', 1}, {'R', 0}}};
+
+    const auto scanline_size = static_cast<int32_t>(channels.size() * width * sizeof(uint16_t));
+
+    auto out = std::vector<uint8_t>{};
+    out.reserve(512 + height * (sizeof(uint64_t) + 2 * sizeof(int32_t) + static_cast<size_t>(scanline_size)));
+
+    // Magic number and version 2, single-part scanline file
+    write_value(out, int32_t{20000630});
+    write_value(out, int32_t{2});
+
+    // Header
+    write_attribute_header(out, "channels", "chlist", static_cast<int32_t>(channels.size() * 18 + 1));
+    for (auto const& [name, index] : channels)
+    {
+        write_string(out, std::string{name});
+        write_value(out, half_pixel_type);
+        write_value(out, int32_t{0}); // pLinear and reserved bytes
+        write_value(out, int32_t{1}); // x sampling
+        write_value(out, int32_t{1}); // y sampling
+    }
+    out.push_back(0);
+    write_attribute_header(out, "compression", "compression", 1);
+    out.push_back(0); // NO_COMPRESSION
+    for (auto const* window : {"dataWindow", "displayWindow"})
+    {
+        write_attribute_header(out, window, "box2i", 16);
+        write_value(out, int32_t{0});
+        write_value(out, int32_t{0});
+        write_value(out, static_cast<int32_t>(width) - 1);
+        write_value(out, static_cast<int32_t>(height) - 1);
+    }
+    write_attribute_header(out, "lineOrder", "lineOrder", 1);
+    out.push_back(0); // INCREASING_Y
+    write_attribute_header(out, "pixelAspectRatio", "float", 4);
+    write_value(out, 1.f);
+    write_attribute_header(out, "screenWindowCenter", "v2f", 8);
+    write_value(out, 0.f);
+    write_value(out, 0.f);
+    write_attribute_header(out, "screenWindowWidth", "float", 4);
+    write_value(out, 1.f);
+    out.push_back(0); // End of the header
+
+    // Offset table: without compression each block is a single scanline, and they all have the same size
+    const auto first_block_offset = out.size() + height * sizeof(uint64_t);
+    const auto block_size         = 2 * sizeof(int32_t) + static_cast<size_t>(scanline_size);
+    for (uint32_t y = 0; y < height; ++y)
+        write_value(out, static_cast<uint64_t>(first_block_offset + y * block_size));
+
+    // Scanlines, from top to bottom
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        write_value(out, static_cast<int32_t>(y));
+        write_value(out, scanline_size);
+        const auto  row_index = flip_vertically ? height - 1 - y : y;
+        auto const* row       = rgba_half_pixels + static_cast<size_t>(row_index) * width * 4; // NOLINT(*-pointer-arithmetic)
+        for (auto const& [name, index] : channels)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+                write_value(out, row[4 * x + index]); // NOLINT(*-pointer-arithmetic)
+        }
+    }
+    return out;
+}
+
+} // namespace p6::internal
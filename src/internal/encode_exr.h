@@ -0,0 +1,12 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace p6::internal {
+
+/// Encodes RGBA half-float pixels with the OpenEXR format (https://openexr.com), uncompressed.
+/// This keeps the full precision of the canvas, which is what you want to do some color grading afterwards.
+/// `flip_vertically` must be true if the rows are ordered from bottom to top, which is the case of the pixels read from OpenGL.
+std::vector<uint8_t> encode_exr(uint16_t const* rgba_half_pixels, uint32_t width, uint32_t height, bool flip_vertically);
+
+} // namespace p6::internal
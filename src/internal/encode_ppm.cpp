@@ -0,0 +1,21 @@
+#include "encode_ppm.h"
+#include <string>
+
+namespace p6::internal {
+
+std::vector<uint8_t> encode_ppm(uint8_t const* rgba_pixels, uint32_t width, uint32_t height, bool flip_vertically)
+{
+    const auto header = "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+    auto       out    = std::vector<uint8_t>(header.begin(), header.end());
+    out.reserve(header.size() + 3 * static_cast<size_t>(width) * height);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        const auto  row_index = flip_vertically ? height - 1 - y : y;
+        auto const* row       = rgba_pixels + static_cast<size_t>(row_index) * width * 4; // NOLINT(*-pointer-arithmetic)
+        for (uint32_t x = 0; x < width; ++x)
+            out.insert(out.end(), row + 4 * x, row + 4 * x + 3); // NOLINT(*-pointer-arithmetic)
+    }
+    return out;
+}
+
+} // namespace p6::internal
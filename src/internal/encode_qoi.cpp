@@ -0,0 +1,125 @@
+#include "encode_qoi.h"
+#include <array>
+#include <cstring>
+
+namespace p6::internal {
+
+namespace {
+
+struct Pixel {
+    uint8_t r, g, b, a;
+
+    bool operator==(Pixel const& o) const { return r == o.r && g == o.g && b == o.b && a == o.a; }
+    bool operator!=(Pixel const& o) const { return !(*this == o); }
+};
+
+constexpr uint8_t op_index = 0x00;
+constexpr uint8_t op_diff  = 0x40;
+constexpr uint8_t op_luma  = 0x80;
+constexpr uint8_t op_run   = 0xc0;
+constexpr uint8_t op_rgb   = 0xfe;
+constexpr uint8_t op_rgba  = 0xff;
+
+constexpr size_t max_run_length = 62;
+
+auto hash(Pixel const& px) -> size_t
+{
+    return (px.r * 3u + px.g * 5u + px.b * 7u + px.a * 11u) % 64u;
+}
+
+void write_u32_big_endian(std::vector<uint8_t>& out, uint32_t value)
+{
+    out.push_back(static_cast<uint8_t>(value >> 24));
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+} // namespace
+
+std::vector<uint8_t> encode_qoi(uint8_t const* rgba_pixels, uint32_t width, uint32_t height, bool flip_vertically)
+{
+    auto out = std::vector<uint8_t>{};
+    out.reserve(14 + static_cast<size_t>(width) * height * 2 + 8); // Most images compress to less than half of their raw size, and the vector grows if needed
+
+    // Header
+    out.insert(out.end(), {'q', 'o', 'i', 'f'});
+    write_u32_big_endian(out, width);
+    write_u32_big_endian(out, height);
+    out.push_back(4); // Channels: RGBA
+    out.push_back(0); // Colorspace: sRGB with linear alpha
+
+    auto   seen     = std::array<Pixel, 64>{};
+    auto   previous = Pixel{0, 0, 0, 255};
+    size_t run      = 0;
+
+    const auto flush_run = [&]() {
+        if (run == 0)
+            return;
+        out.push_back(static_cast<uint8_t>(op_run | (run - 1)));
+        run = 0;
+    };
+
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        const auto  row_index = flip_vertically ? height - 1 - y : y;
+        auto const* row       = rgba_pixels + static_cast<size_t>(row_index) * width * 4; // NOLINT(*-pointer-arithmetic)
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            auto px = Pixel{};
+            std::memcpy(&px, row + static_cast<size_t>(x) * 4, 4); // NOLINT(*-pointer-arithmetic)
+
+            if (px == previous)
+            {
+                run++;
+                if (run == max_run_length)
+                    flush_run();
+                continue;
+            }
+            flush_run();
+
+            const auto index = hash(px);
+            if (seen[index] == px)
+            {
+                out.push_back(static_cast<uint8_t>(op_index | index));
+            }
+            else
+            {
+                seen[index] = px;
+                if (px.a == previous.a)
+                {
+                    const auto dr   = static_cast<int8_t>(px.r - previous.r);
+                    const auto dg   = static_cast<int8_t>(px.g - previous.g);
+                    const auto db   = static_cast<int8_t>(px.b - previous.b);
+                    const auto dr_g = static_cast<int8_t>(dr - dg);
+                    const auto db_g = static_cast<int8_t>(db - dg);
+                    if (dr > -3 && dr < 2 && dg > -3 && dg < 2 && db > -3 && db < 2)
+                    {
+                        out.push_back(static_cast<uint8_t>(op_diff | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2)));
+                    }
+                    else if (dr_g > -9 && dr_g < 8 && dg > -33 && dg < 32 && db_g > -9 && db_g < 8)
+                    {
+                        out.push_back(static_cast<uint8_t>(op_luma | (dg + 32)));
+                        out.push_back(static_cast<uint8_t>((dr_g + 8) << 4 | (db_g + 8)));
+                    }
+                    else
+                    {
+                        out.insert(out.end(), {op_rgb, px.r, px.g, px.b});
+                    }
+                }
+                else
+                {
+                    out.insert(out.end(), {op_rgba, px.r, px.g, px.b, px.a});
+                }
+            }
+            previous = px;
+        }
+    }
+    flush_run();
+
+    // End marker
+    out.insert(out.end(), {0, 0, 0, 0, 0, 0, 0, 1});
+    return out;
+}
+
+} // namespace p6::internal
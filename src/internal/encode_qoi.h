@@ -0,0 +1,12 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace p6::internal {
+
+/// Encodes RGBA 8-bit pixels with the "Quite OK Image" format (https://qoiformat.org).
+/// It is lossless like PNG, but many times faster to encode, which makes it great to capture frames in real time.
+/// `flip_vertically` must be true if the rows are ordered from bottom to top, which is the case of the pixels read from OpenGL.
+std::vector<uint8_t> encode_qoi(uint8_t const* rgba_pixels, uint32_t width, uint32_t height, bool flip_vertically);
+
+} // namespace p6::internal
@@ -0,0 +1,19 @@
+#include "flip_rows_vertically.h"
+#include <algorithm>
+
+namespace p6::internal {
+
+std::vector<uint8_t> flip_rows_vertically(std::vector<uint8_t> const& pixels, size_t row_size_in_bytes)
+{
+    const auto rows_count = pixels.size() / row_size_in_bytes;
+    auto       out        = std::vector<uint8_t>(pixels.size());
+    for (size_t y = 0; y < rows_count; ++y)
+    {
+        std::copy_n(pixels.begin() + static_cast<std::ptrdiff_t>((rows_count - 1 - y) * row_size_in_bytes),
+                    row_size_in_bytes,
+                    out.begin() + static_cast<std::ptrdiff_t>(y * row_size_in_bytes));
+    }
+    return out;
+}
+
+} // namespace p6::internal
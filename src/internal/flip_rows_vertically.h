@@ -0,0 +1,11 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace p6::internal {
+
+/// Returns the same pixels with the rows in reverse order, e.g. to go from OpenGL's bottom-to-top order to the top-to-bottom order that most file formats use.
+std::vector<uint8_t> flip_rows_vertically(std::vector<uint8_t> const& pixels, size_t row_size_in_bytes);
+
+} // namespace p6::internal
@@ -0,0 +1,22 @@
+#include "flush_pending_draws.h"
+
+namespace p6::internal {
+
+static auto flush_pending_draws_callback() -> std::function<void()>&
+{
+    static auto instance = std::function<void()>{};
+    return instance;
+}
+
+void set_flush_pending_draws_callback(std::function<void()> callback)
+{
+    flush_pending_draws_callback() = std::move(callback);
+}
+
+void flush_pending_draws()
+{
+    if (flush_pending_draws_callback())
+        flush_pending_draws_callback()();
+}
+
+} // namespace p6::internal
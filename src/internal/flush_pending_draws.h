@@ -0,0 +1,15 @@
+#pragma once
+
+#include <functional>
+
+namespace p6::internal {
+
+/// The Context batches some of its drawing commands instead of sending them to the GPU immediately.
+/// This sets the function that will render everything that has been batched so far.
+void set_flush_pending_draws_callback(std::function<void()> callback);
+
+/// Renders everything that has been batched so far.
+/// Must be called before reading the content of a canvas from a place that doesn't go through the Context (e.g. `p6::save_image()`).
+void flush_pending_draws();
+
+} // namespace p6::internal
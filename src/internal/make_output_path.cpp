@@ -0,0 +1,13 @@
+#include "make_output_path.h"
+#include <exe_path/exe_path.h>
+#include "append_number_if_file_already_exists.h"
+
+namespace p6::internal {
+
+std::filesystem::path make_output_path(std::filesystem::path const& path)
+{
+    return append_number_if_file_already_exists(path.is_relative() ? exe_path::dir() / path
+                                                                   : path);
+}
+
+} // namespace p6::internal
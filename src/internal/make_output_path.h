@@ -0,0 +1,11 @@
+#pragma once
+
+#include <filesystem>
+
+namespace p6::internal {
+
+/// Makes the path absolute (relative paths are relative to the directory containing the executable), and appends a number to it if it already exists, so that we never overwrite a file.
+/// Unlike make_absolute_path(), the path doesn't need to exist yet.
+std::filesystem::path make_output_path(std::filesystem::path const& path);
+
+} // namespace p6::internal
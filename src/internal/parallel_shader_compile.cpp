@@ -0,0 +1,42 @@
+#include "parallel_shader_compile.h"
+#include "glfw.h"
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+namespace p6::internal {
+
+static bool s_has_been_enabled{false};
+static bool s_is_supported{false};
+
+void enable_parallel_shader_compile()
+{
+    if (s_has_been_enabled)
+        return;
+    s_has_been_enabled = true;
+
+    // We query the function through GLFW because our OpenGL loader isn't necessarily generated with this extension
+    using MaxShaderCompilerThreads = void(APIENTRY*)(GLuint count);
+    auto const* name               = glfwExtensionSupported("GL_KHR_parallel_shader_compile") ? "glMaxShaderCompilerThreadsKHR"
+                                     : glfwExtensionSupported("GL_ARB_parallel_shader_compile") ? "glMaxShaderCompilerThreadsARB"
+                                                                                                  : nullptr;
+    if (!name)
+        return;
+    auto const max_shader_compiler_threads = reinterpret_cast<MaxShaderCompilerThreads>(glfwGetProcAddress(name)); // NOLINT
+    if (!max_shader_compiler_threads)
+        return;
+    max_shader_compiler_threads(0xFFFFFFFF); // Let the driver choose the number of threads
+    s_is_supported = true;
+}
+
+bool program_has_finished_linking(GLuint program)
+{
+    if (!s_is_supported)
+        return true;
+    GLint is_complete{GL_FALSE};
+    glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &is_complete);
+    return is_complete == GL_TRUE;
+}
+
+} // namespace p6::internal
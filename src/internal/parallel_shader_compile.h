@@ -0,0 +1,14 @@
+#pragma once
+#include <glpp/glpp.hpp>
+
+namespace p6::internal {
+
+/// If the driver supports GL_KHR_parallel_shader_compile (or its ARB equivalent), allows it to compile shaders on as many background threads as it wants.
+/// Does nothing after the first call.
+void enable_parallel_shader_compile();
+
+/// Returns false iff we know for sure that the driver is still compiling / linking the program, i.e. checking the link status would block.
+/// If the driver can't tell us, this always returns true.
+bool program_has_finished_linking(GLuint program);
+
+} // namespace p6::internal
@@ -0,0 +1,263 @@
+#include "program_binary_cache.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string_view>
+#include <vector>
+
+namespace p6::internal {
+
+namespace {
+struct CacheSettings {
+    std::filesystem::path directory;
+    std::uintmax_t        max_size_in_bytes;
+    std::uintmax_t        size_in_bytes; // Kept up to date as we write and remove files, so that we only need to scan the directory when it has grown too big
+};
+
+struct CacheFile {
+    std::filesystem::path           path;
+    std::uintmax_t                  size;
+    std::filesystem::file_time_type last_use;
+};
+
+struct FileHeader {
+    std::array<char, 4> magic;
+    uint32_t            format_version;
+    uint64_t            cache_key;
+    GLenum              binary_format;
+    uint32_t            binary_size;
+};
+} // namespace
+
+static std::optional<CacheSettings> s_settings{};
+
+static constexpr std::array<char, 4> magic{'p', '6', 'p', 'b'};
+static constexpr uint32_t            format_version = 1;
+static constexpr std::string_view    file_extension = ".p6bin";
+
+static auto files_in_cache(std::filesystem::path const& directory) -> std::vector<CacheFile>
+{
+    auto            files = std::vector<CacheFile>{};
+    std::error_code err;
+    for (auto it = std::filesystem::directory_iterator{directory, err}; !err && it != std::filesystem::directory_iterator{}; it.increment(err))
+    {
+        if (!it->is_regular_file(err) || it->path().extension() != file_extension)
+            continue;
+        auto const size     = it->file_size(err);
+        auto const last_use = it->last_write_time(err);
+        if (err)
+            continue;
+        files.push_back({it->path(), size, last_use});
+    }
+    return files;
+}
+
+static auto total_size(std::vector<CacheFile> const& files) -> std::uintmax_t
+{
+    std::uintmax_t size = 0;
+    for (auto const& file : files)
+        size += file.size;
+    return size;
+}
+
+void enable_program_binary_cache(std::filesystem::path const& directory, std::uintmax_t max_size_in_bytes)
+{
+    s_settings = CacheSettings{directory, max_size_in_bytes, total_size(files_in_cache(directory))};
+}
+
+/// Returns 0 if the file doesn't exist.
+static auto file_size_or_zero(std::filesystem::path const& path) -> std::uintmax_t
+{
+    std::error_code err;
+    auto const      size = std::filesystem::file_size(path, err);
+    return err ? 0 : size;
+}
+
+static void remove_file(std::filesystem::path const& path)
+{
+    auto const      size = file_size_or_zero(path);
+    std::error_code err;
+    if (std::filesystem::remove(path, err))
+        s_settings->size_in_bytes -= std::min(size, s_settings->size_in_bytes);
+}
+
+void disable_program_binary_cache()
+{
+    s_settings.reset();
+}
+
+static bool driver_supports_program_binaries()
+{
+    GLint formats_count{0};
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats_count);
+    return formats_count > 0;
+}
+
+// FNV-1a: we only need a fast hash with few collisions, not a cryptographic one
+static auto hash(std::string_view data, uint64_t hash = 14695981039346656037ull) -> uint64_t
+{
+    for (char const c : data)
+    {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static auto gl_string(GLenum name) -> std::string_view
+{
+    auto const* str = glGetString(name);
+    return str ? reinterpret_cast<const char*>(str) : ""; // NOLINT
+}
+
+auto program_binary_cache_key(ShaderSources const& sources) -> std::optional<uint64_t>
+{
+    if (!s_settings || !driver_supports_program_binaries())
+        return std::nullopt;
+
+    // A binary can only be loaded by the exact same driver that produced it
+    auto key = hash(gl_string(GL_VENDOR));
+    key      = hash(gl_string(GL_RENDERER), key);
+    key      = hash(gl_string(GL_VERSION), key);
+
+    auto const add_stage = [&](std::string_view stage_name, std::optional<std::string> const& source_code) {
+        if (!source_code)
+            return;
+        key = hash(stage_name, key); // So that the same code used in a different stage gives a different key
+        key = hash(*source_code, key);
+    };
+    add_stage("vertex", sources.vertex);
+    add_stage("fragment", sources.fragment);
+    add_stage("geometry", sources.geometry);
+    add_stage("tessellation_control", sources.tessellation_control);
+    add_stage("tessellation_evaluation", sources.tessellation_evaluation);
+    return key;
+}
+
+static auto file_path(uint64_t cache_key) -> std::filesystem::path
+{
+    auto name = std::stringstream{};
+    name << std::hex << std::setw(16) << std::setfill('0') << cache_key << file_extension;
+    return s_settings->directory / name.str();
+}
+
+bool load_program_binary(GLuint program, std::optional<uint64_t> cache_key)
+{
+    if (!cache_key || !s_settings)
+        return false;
+
+    auto const path = file_path(*cache_key);
+    auto       file = std::ifstream{path, std::ios::binary};
+    if (!file)
+        return false;
+
+    auto header = FileHeader{};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header)); // NOLINT
+    if (!file
+        || header.magic != magic
+        || header.format_version != format_version
+        || header.cache_key != *cache_key)
+    {
+        return false;
+    }
+    auto binary = std::vector<char>(header.binary_size);
+    file.read(binary.data(), static_cast<std::streamsize>(binary.size()));
+    if (!file)
+        return false;
+    file.close();
+
+    glProgramBinary(program, header.binary_format, binary.data(), static_cast<GLsizei>(binary.size()));
+    GLint link_status{GL_FALSE};
+    glGetProgramiv(program, GL_LINK_STATUS, &link_status);
+    if (link_status != GL_TRUE) // The driver can reject a binary for reasons that are not reflected in its version string, so we will compile from source and overwrite it
+    {
+        remove_file(path);
+        return false;
+    }
+    std::error_code err;
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), err); // Mark it as recently used, so that it is one of the last to be removed when the cache is full
+    return true;
+}
+
+void prepare_program_for_binary_cache(GLuint program, std::optional<uint64_t> cache_key)
+{
+    if (!cache_key)
+        return;
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+/// Only called when the cache has grown too big, because it needs to look at all the files.
+static void remove_least_recently_used_files(CacheSettings& settings)
+{
+    auto files             = files_in_cache(settings.directory);
+    settings.size_in_bytes = total_size(files); // Another app using the same directory might have added or removed files
+    std::sort(files.begin(), files.end(), [](CacheFile const& a, CacheFile const& b) {
+        return a.last_use < b.last_use;
+    });
+    for (auto const& file : files)
+    {
+        if (settings.size_in_bytes <= settings.max_size_in_bytes)
+            break;
+        std::error_code err;
+        if (std::filesystem::remove(file.path, err))
+            settings.size_in_bytes -= file.size;
+    }
+}
+
+void save_program_binary(GLuint program, std::optional<uint64_t> cache_key)
+{
+    if (!cache_key || !s_settings)
+        return;
+
+    GLint link_status{GL_FALSE};
+    glGetProgramiv(program, GL_LINK_STATUS, &link_status);
+    GLint binary_length{0};
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binary_length);
+    if (link_status != GL_TRUE || binary_length <= 0)
+        return;
+
+    auto    binary = std::vector<char>(static_cast<size_t>(binary_length));
+    GLenum  binary_format{0};
+    GLsizei written_length{0};
+    glGetProgramBinary(program, binary_length, &written_length, &binary_format, binary.data());
+    if (written_length <= 0)
+        return;
+
+    std::error_code err;
+    std::filesystem::create_directories(s_settings->directory, err);
+    // Write to a temporary file first, so that another app using the same cache never reads a half-written file
+    auto const path      = file_path(*cache_key);
+    auto       temp_path = path;
+    temp_path += ".tmp";
+    {
+        auto file = std::ofstream{temp_path, std::ios::binary};
+        if (!file)
+            return;
+        auto const header = FileHeader{magic, format_version, *cache_key, binary_format, static_cast<uint32_t>(written_length)};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header)); // NOLINT
+        file.write(binary.data(), written_length);
+        if (!file)
+        {
+            file.close();
+            std::filesystem::remove(temp_path, err);
+            return;
+        }
+    }
+    auto const previous_size = file_size_or_zero(path);
+    std::filesystem::rename(temp_path, path, err);
+    if (err)
+    {
+        std::filesystem::remove(temp_path, err);
+        return;
+    }
+    s_settings->size_in_bytes += sizeof(FileHeader) + static_cast<std::uintmax_t>(written_length);
+    s_settings->size_in_bytes -= std::min(previous_size, s_settings->size_in_bytes);
+
+    if (s_settings->size_in_bytes > s_settings->max_size_in_bytes)
+        remove_least_recently_used_files(*s_settings);
+}
+
+} // namespace p6::internal
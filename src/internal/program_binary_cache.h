@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <glpp/glpp.hpp>
+#include <optional>
+#include "../Shader.h"
+
+namespace p6::internal {
+
+void enable_program_binary_cache(std::filesystem::path const& directory, std::uintmax_t max_size_in_bytes);
+void disable_program_binary_cache();
+
+/// Returns a key that identifies the program made of these sources, on the current graphics driver.
+/// Returns nullopt if the cache is disabled or not supported by the driver.
+auto program_binary_cache_key(ShaderSources const& sources) -> std::optional<uint64_t>;
+
+/// Returns true iff the program has been found in the cache, in which case it is already linked and ready to use.
+bool load_program_binary(GLuint program, std::optional<uint64_t> cache_key);
+/// Must be called before linking the program, otherwise the driver might not allow us to retrieve its binary.
+void prepare_program_for_binary_cache(GLuint program, std::optional<uint64_t> cache_key);
+/// Saves the program in the cache, if it has been linked successfully.
+void save_program_binary(GLuint program, std::optional<uint64_t> cache_key);
+
+} // namespace p6::internal
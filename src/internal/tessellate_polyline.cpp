@@ -0,0 +1,199 @@
+#include "tessellate_polyline.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "../math_constants.h"
+
+namespace p6::internal {
+
+// Maximum distance between a round join / cap and the polygon that approximates it.
+static constexpr float arc_precision = 0.0005f;
+// Beyond this ratio between the length of the miter and the width of the line, miter joins are replaced by bevels, otherwise sharp angles would produce extremely long spikes.
+static constexpr float miter_limit = 4.f;
+
+namespace {
+struct Segment {
+    glm::vec2 direction;
+    glm::vec2 normal; // Points to the left of the direction
+    float     length;
+    // The four corners of the quad that covers the segment
+    glm::vec2 start_left;
+    glm::vec2 start_right;
+    glm::vec2 end_left;
+    glm::vec2 end_right;
+};
+} // namespace
+
+static auto cross(glm::vec2 a, glm::vec2 b) -> float
+{
+    return a.x * b.y - a.y * b.x;
+}
+
+static auto rotate(glm::vec2 v, float angle) -> glm::vec2
+{
+    const float c = std::cos(angle);
+    const float s = std::sin(angle);
+    return {c * v.x - s * v.y, s * v.x + c * v.y};
+}
+
+static void push_triangle(std::vector<glm::vec2>& triangles, glm::vec2 a, glm::vec2 b, glm::vec2 c)
+{
+    triangles.push_back(a);
+    triangles.push_back(b);
+    triangles.push_back(c);
+}
+
+/// Adds a fan of triangles between `pivot` and an arc of circle of center `center`, that starts in the direction `from` and rotates by `angle`.
+static void push_arc(std::vector<glm::vec2>& triangles, glm::vec2 pivot, glm::vec2 center, glm::vec2 from, float angle, float radius)
+{
+    const float max_step = 2.f * std::acos(1.f - std::min(arc_precision / radius, 1.f));
+    const int   count    = std::clamp(static_cast<int>(std::ceil(std::abs(angle) / max_step)), 1, 64);
+    auto        previous = center + radius * from;
+    for (int i = 1; i <= count; ++i)
+    {
+        const auto current = center + radius * rotate(from, angle * static_cast<float>(i) / static_cast<float>(count));
+        push_triangle(triangles, pivot, previous, current);
+        previous = current;
+    }
+}
+
+static auto signed_angle_between(glm::vec2 from, glm::vec2 to) -> float
+{
+    return std::atan2(cross(from, to), glm::dot(from, to));
+}
+
+/// Fills the gap between two consecutive segments, and moves their inner corners to the same point so that they don't overlap.
+static void join(Segment& previous, Segment& next, glm::vec2 point, PolylineStyle const& style, std::vector<glm::vec2>& triangles)
+{
+    const float turn = cross(previous.direction, next.direction);
+    const float dot  = glm::dot(previous.direction, next.direction);
+    if (std::abs(turn) < 1e-6f && dot > 0.f) // Straight line, the segments already fit together
+        return;
+
+    const float outer_side  = turn > 0.f ? -1.f : 1.f; // When turning left, the outer side of the join is on the right
+    const auto  outer_prev  = point + outer_side * style.half_width * previous.normal;
+    const auto  outer_next  = point + outer_side * style.half_width * next.normal;
+    const auto  miter_sum   = previous.normal + next.normal;
+    const float miter_ratio = glm::length(miter_sum) > 1e-6f // How much longer the miter is than the half width
+                                  ? 2.f / glm::length(miter_sum)
+                                  : std::numeric_limits<float>::infinity();
+
+    // Use the intersection of the two inner edges as the inner corner of both segments.
+    // This is only possible if that point doesn't go past the other end of the segments.
+    auto        pivot               = point;
+    const float inner_overlap       = style.half_width * std::sqrt(std::max(miter_ratio * miter_ratio - 1.f, 0.f));
+    const bool  can_use_inner_miter = std::isfinite(miter_ratio) && inner_overlap <= 0.5f * std::min(previous.length, next.length);
+    if (can_use_inner_miter)
+    {
+        pivot = point - outer_side * style.half_width * miter_ratio * glm::normalize(miter_sum);
+        if (outer_side > 0.f)
+        {
+            previous.end_right = pivot;
+            next.start_right   = pivot;
+        }
+        else
+        {
+            previous.end_left = pivot;
+            next.start_left   = pivot;
+        }
+    }
+
+    switch (style.join)
+    {
+    case LineJoin::Round:
+    {
+        push_arc(triangles, pivot, point, outer_side * previous.normal, signed_angle_between(previous.normal, next.normal), style.half_width);
+        break;
+    }
+    case LineJoin::Miter:
+    {
+        if (miter_ratio <= miter_limit)
+        {
+            const auto miter = point + outer_side * style.half_width * miter_ratio * glm::normalize(miter_sum);
+            push_triangle(triangles, pivot, outer_prev, miter);
+            push_triangle(triangles, pivot, miter, outer_next);
+            break;
+        }
+        [[fallthrough]];
+    }
+    case LineJoin::Bevel:
+    {
+        push_triangle(triangles, pivot, outer_prev, outer_next);
+        break;
+    }
+    }
+}
+
+static void cap(Segment const& segment, glm::vec2 point, bool is_start, PolylineStyle const& style, std::vector<glm::vec2>& triangles)
+{
+    if (style.cap != LineCap::Round) // Square caps are handled by extending the segments, and butt caps don't need anything
+        return;
+    const float side = is_start ? 1.f : -1.f;
+    push_arc(triangles, point, point, segment.normal, side * PI, style.half_width);
+}
+
+void tessellate_polyline(std::vector<glm::vec2> const& points, bool is_closed, PolylineStyle const& style, std::vector<glm::vec2>& triangles)
+{
+    // Remove consecutive duplicates, they don't have a direction
+    auto unique_points = std::vector<glm::vec2>{};
+    unique_points.reserve(points.size());
+    for (auto const& point : points)
+    {
+        if (unique_points.empty() || point != unique_points.back())
+            unique_points.push_back(point);
+    }
+    if (is_closed && unique_points.size() > 1 && unique_points.front() == unique_points.back())
+        unique_points.pop_back();
+    if (unique_points.size() < 2 || style.half_width <= 0.f)
+        return;
+    if (unique_points.size() == 2)
+        is_closed = false;
+
+    const auto points_count   = unique_points.size();
+    const auto segments_count = is_closed ? points_count : points_count - 1;
+
+    auto segments = std::vector<Segment>{};
+    segments.reserve(segments_count);
+    for (size_t i = 0; i < segments_count; ++i)
+    {
+        auto        start     = unique_points[i];
+        auto        end       = unique_points[(i + 1) % points_count];
+        const auto  direction = glm::normalize(end - start);
+        const float length    = glm::distance(start, end);
+        if (!is_closed && style.cap == LineCap::Square)
+        {
+            if (i == 0)
+                start -= style.half_width * direction;
+            if (i == segments_count - 1)
+                end += style.half_width * direction;
+        }
+        const auto normal = glm::vec2{-direction.y, direction.x};
+        segments.push_back({
+            direction,
+            normal,
+            length,
+            start + style.half_width * normal,
+            start - style.half_width * normal,
+            end + style.half_width * normal,
+            end - style.half_width * normal,
+        });
+    }
+
+    for (size_t i = 1; i < segments_count; ++i)
+        join(segments[i - 1], segments[i], unique_points[i], style, triangles);
+    if (is_closed)
+        join(segments.back(), segments.front(), unique_points.front(), style, triangles);
+    else
+    {
+        cap(segments.front(), unique_points.front(), true, style, triangles);
+        cap(segments.back(), unique_points.back(), false, style, triangles);
+    }
+
+    for (auto const& segment : segments)
+    {
+        push_triangle(triangles, segment.start_left, segment.start_right, segment.end_right);
+        push_triangle(triangles, segment.start_left, segment.end_right, segment.end_left);
+    }
+}
+
+} // namespace p6::internal
@@ -0,0 +1,27 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+#include "../Path.h"
+
+namespace p6::internal {
+
+/// Everything that affects the shape of a tessellated line.
+struct PolylineStyle {
+    float    half_width;
+    LineJoin join;
+    LineCap  cap;
+
+    friend bool operator==(PolylineStyle const& a, PolylineStyle const& b)
+    {
+        return a.half_width == b.half_width
+               && a.join == b.join
+               && a.cap == b.cap;
+    }
+    friend bool operator!=(PolylineStyle const& a, PolylineStyle const& b) { return !(a == b); }
+};
+
+/// Turns a line going through all the `points` into triangles, and appends them to `triangles` (three vertices per triangle).
+/// The triangles don't overlap (except around joins between segments that are shorter than the line is wide), so the line can be drawn with a semi-transparent color.
+void tessellate_polyline(std::vector<glm::vec2> const& points, bool is_closed, PolylineStyle const& style, std::vector<glm::vec2>& triangles);
+
+} // namespace p6::internal
@@ -0,0 +1,15 @@
+#include "write_file.h"
+#include <fstream>
+#include <stdexcept>
+
+namespace p6::internal {
+
+void write_file(std::filesystem::path const& path, std::vector<uint8_t> const& data)
+{
+    auto file = std::ofstream{path, std::ios::binary};
+    file.write(reinterpret_cast<char const*>(data.data()), static_cast<std::streamsize>(data.size())); // NOLINT(*-reinterpret-cast)
+    if (!file)
+        throw std::runtime_error{"[p6] Could not write \"" + path.string() + "\"."};
+}
+
+} // namespace p6::internal
@@ -0,0 +1,11 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace p6::internal {
+
+/// Writes the bytes into a file, replacing it if it already exists. Throws if the file can't be written.
+void write_file(std::filesystem::path const& path, std::vector<uint8_t> const& data);
+
+} // namespace p6::internal